@@ -0,0 +1,307 @@
+/*
+ * Binárny vyhľadávací strom — vyvážená varianta (AVL)
+ *
+ * Same API as the recursive variant, but bst_insert and bst_delete rotate
+ * nodes on the way back up so that the heights of the two subtrees of every
+ * node differ by at most one. The height of the tree stays below
+ * 1.45 log2(n + 2) for any order of insertions, so search, insert and delete
+ * are O(log n) and the recursion depth stays small.
+ *
+ * bst_node_t cannot be changed, so every node is allocated as the first
+ * member of avl_node_t, which adds the height of its subtree. Only this file
+ * allocates nodes, the cast back from bst_node_t is therefore safe.
+ */
+
+#include "../btree.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// Uzol stromu s výškou podstromu
+typedef struct avl_node {
+  bst_node_t node; // uzol z btree.h, musí byť prvý
+  int height;      // výška podstromu, list má výšku 1
+} avl_node_t;
+
+static int avl_height(bst_node_t *tree)
+{
+  return tree != NULL ? ((avl_node_t*)tree)->height : 0;
+}
+
+static void avl_update_height(bst_node_t *tree)
+{
+  int left = avl_height(tree->left);
+  int right = avl_height(tree->right);
+  ((avl_node_t*)tree)->height = (left > right ? left : right) + 1;
+}
+
+/*
+ * Rotations: the child on the other side becomes the root of the subtree.
+ */
+static void avl_rotate_left(bst_node_t **tree)
+{
+  bst_node_t *root = (*tree)->right;
+  (*tree)->right = root->left;
+  root->left = *tree;
+  avl_update_height(*tree);
+  avl_update_height(root);
+  *tree = root;
+}
+
+static void avl_rotate_right(bst_node_t **tree)
+{
+  bst_node_t *root = (*tree)->left;
+  (*tree)->left = root->right;
+  root->right = *tree;
+  avl_update_height(*tree);
+  avl_update_height(root);
+  *tree = root;
+}
+
+/*
+ * Restores the balance of a subtree whose children are balanced and differ
+ * in height by at most two, as they do after one insert or delete below it.
+ */
+static void avl_rebalance(bst_node_t **tree)
+{
+  if (*tree == NULL) return;
+
+  int balance = avl_height((*tree)->left) - avl_height((*tree)->right);
+  if (balance > 1)
+  {
+    // Left-right case first turns into left-left
+    if (avl_height((*tree)->left->left) < avl_height((*tree)->left->right))
+      avl_rotate_left(&(*tree)->left);
+    avl_rotate_right(tree);
+  }
+  else if (balance < -1)
+  {
+    if (avl_height((*tree)->right->right) < avl_height((*tree)->right->left))
+      avl_rotate_right(&(*tree)->right);
+    avl_rotate_left(tree);
+  }
+  else
+  {
+    avl_update_height(*tree);
+  }
+}
+
+/*
+ * Inicializácia stromu.
+ *
+ * Užívateľ musí zaistiť, že incializácia sa nebude opakovane volať nad
+ * inicializovaným stromom. V opačnom prípade môže dôjsť k úniku pamäte (memory
+ * leak). Keďže neinicializovaný ukazovateľ má nedefinovanú hodnotu, nie je
+ * možné toto detegovať vo funkcii.
+ */
+void bst_init(bst_node_t **tree)
+{
+  if (tree == NULL)
+    return;
+  *tree = NULL;
+}
+
+/*
+ * Nájdenie uzlu v strome.
+ *
+ * V prípade úspechu vráti funkcia hodnotu true a do premennej value zapíše
+ * hodnotu daného uzlu. V opačnom prípade funckia vráti hodnotu false a premenná
+ * value ostáva nezmenená.
+ *
+ * The tree is balanced, so a loop visits at most its height of nodes.
+ */
+bool bst_search(bst_node_t *tree, char key, int *value)
+{
+  while (tree != NULL)
+  {
+    if (tree->key == key)
+    {
+      *value = tree->value;
+      return true;
+    }
+
+    tree = key < tree->key ? tree->left : tree->right;
+  }
+
+  return false;
+}
+
+/*
+ * Vloženie uzlu do stromu.
+ *
+ * Pokiaľ uzol so zadaným kľúčom v strome už existuje, nahraďte jeho hodnotu.
+ * Inak vložte nový listový uzol.
+ *
+ * Every subtree on the path of the new leaf is rebalanced on the way back,
+ * which takes at most one single or double rotation.
+ */
+void bst_insert(bst_node_t **tree, char key, int value)
+{
+  if (tree == NULL) return;
+
+  if (*tree == NULL)
+  {
+    avl_node_t *node = (avl_node_t*)malloc(sizeof(avl_node_t));
+    if (node == NULL) return;
+
+    node->node.key = key;
+    node->node.value = value;
+    node->node.left = NULL;
+    node->node.right = NULL;
+    node->height = 1;
+    *tree = &node->node;
+    return;
+  }
+
+  if ((*tree)->key == key)
+  {
+    // Only the value changes, the shape stays
+    (*tree)->value = value;
+    return;
+  }
+
+  if (key < (*tree)->key)
+    bst_insert(&(*tree)->left, key, value);
+  else
+    bst_insert(&(*tree)->right, key, value);
+
+  avl_rebalance(tree);
+}
+
+/*
+ * Pomocná funkcia ktorá nahradí uzol najpravejším potomkom.
+ *
+ * Kľúč a hodnota uzlu target budú nahradené kľúčom a hodnotou najpravejšieho
+ * uzlu podstromu tree. Najpravejší potomok bude odstránený. Funkcia korektne
+ * uvoľní všetky alokované zdroje odstráneného uzlu.
+ *
+ * Funkcia predpokladá že hodnota tree nie je NULL.
+ *
+ * The subtrees on the path to the rightmost node are rebalanced on the way
+ * back, the caller rebalances the subtree above tree.
+ */
+void bst_replace_by_rightmost(bst_node_t *target, bst_node_t **tree)
+{
+  if (tree == NULL) return;
+  if (*tree == NULL) return;
+  if (target == NULL) return;
+
+  if ((*tree)->right != NULL)
+  {
+    bst_replace_by_rightmost(target, &(*tree)->right);
+    avl_rebalance(tree);
+  }
+  else
+  {
+    bst_node_t *tmp = *tree;
+
+    target->key = tmp->key;
+    target->value = tmp->value;
+    *tree = tmp->left;
+
+    free(tmp);
+  }
+}
+
+/*
+ * Odstránenie uzlu v strome.
+ *
+ * Pokiaľ uzol so zadaným kľúčom neexistuje, funkcia nič nerobí.
+ * Pokiaľ má odstránený uzol jeden podstrom, zdedí ho otec odstráneného uzla.
+ * Pokiaľ má odstránený uzol oba podstromy, je nahradený najpravejším uzlom
+ * ľavého podstromu. Najpravejší uzol nemusí byť listom!
+ * Funkcia korektne uvoľní všetky alokované zdroje odstráneného uzlu.
+ *
+ * Unlike insert, a delete may need a rotation at every level of the path.
+ */
+void bst_delete(bst_node_t **tree, char key)
+{
+  if (tree == NULL) return;
+  if (*tree == NULL) return;
+
+  if (key < (*tree)->key)
+  {
+    bst_delete(&(*tree)->left, key);
+  }
+  else if (key > (*tree)->key)
+  {
+    bst_delete(&(*tree)->right, key);
+  }
+  else if ((*tree)->left != NULL && (*tree)->right != NULL)
+  {
+    bst_replace_by_rightmost(*tree, &(*tree)->left);
+  }
+  else
+  {
+    // A leaf or a node with one subtree, which is balanced already
+    bst_node_t *tmp = *tree;
+    *tree = tmp->left != NULL ? tmp->left : tmp->right;
+    free(tmp);
+    return;
+  }
+
+  avl_rebalance(tree);
+}
+
+/*
+ * Zrušenie celého stromu.
+ *
+ * Po zrušení sa celý strom bude nachádzať v rovnakom stave ako po
+ * inicializácii. Funkcia korektne uvoľní všetky alokované zdroje rušených
+ * uzlov.
+ */
+void bst_dispose(bst_node_t **tree)
+{
+  if (tree == NULL) return;
+  if (*tree == NULL) return;
+
+  bst_dispose(&(*tree)->left);
+  bst_dispose(&(*tree)->right);
+
+  free(*tree);
+  *tree = NULL;
+}
+
+/*
+ * Preorder prechod stromom.
+ *
+ * Pre aktuálne spracovávaný uzol nad ním zavolajte funkciu bst_print_node.
+ */
+void bst_preorder(bst_node_t *tree)
+{
+  if (tree != NULL)
+  {
+    bst_print_node(tree);
+    bst_preorder(tree->left);
+    bst_preorder(tree->right);
+  }
+}
+
+/*
+ * Inorder prechod stromom.
+ *
+ * Pre aktuálne spracovávaný uzol nad ním zavolajte funkciu bst_print_node.
+ */
+void bst_inorder(bst_node_t *tree)
+{
+  if (tree != NULL)
+  {
+    bst_inorder(tree->left);
+    bst_print_node(tree);
+    bst_inorder(tree->right);
+  }
+}
+
+/*
+ * Postorder prechod stromom.
+ *
+ * Pre aktuálne spracovávaný uzol nad ním zavolajte funkciu bst_print_node.
+ */
+void bst_postorder(bst_node_t *tree)
+{
+  if (tree != NULL)
+  {
+    bst_postorder(tree->left);
+    bst_postorder(tree->right);
+    bst_print_node(tree);
+  }
+}
@@ -0,0 +1,154 @@
+/*
+ * Benchmark of the B+ tree against a binary search tree.
+ *
+ * The rec and iter variants are limited to char keys, so the binary tree is
+ * the typed tree of typed_bst.h with the same 64-bit keys, which searches
+ * like the iter variant. BENCH_KEYS random keys are inserted, searched for
+ * (present and missing), traversed in order and deleted; times are in ns
+ * per key. Sorted keys would turn the binary tree into a list.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "../typed/typed_bst.h"
+#include "bplus.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define BENCH_KEYS 1000000
+
+BSTDEC(uint64_t, int, id)
+BSTDEF(uint64_t, int, id, BST_CMP_NUMBER)
+
+static volatile long bench_sink;
+
+static double seconds(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// splitmix64, odd keys are present and even keys missing
+static uint64_t bench_key(uint64_t i) {
+  uint64_t z = (i + 1) * 0x9e3779b97f4a7c15u;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9u;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebu;
+  return (z ^ (z >> 31)) | 1;
+}
+
+static void sum_bpt(bpt_key_t key, int value, void *data) {
+  *(long *)data += value;
+}
+
+static void sum_bst(uint64_t key, int value, void *data) {
+  *(long *)data += value;
+}
+
+static void print_row(const char *name, double start, double end) {
+  printf("%12s %14.1f\n", name, (end - start) / BENCH_KEYS * 1e9);
+}
+
+static void bench_bpt(uint64_t *keys) {
+  bpt_tree_t tree;
+  bpt_init(&tree);
+  int value;
+  long sum = 0;
+
+  printf("[B+ tree] %d keys per node\n", BPT_KEYS);
+  double start = seconds();
+  for (int i = 0; i < BENCH_KEYS; i++) {
+    bpt_insert(&tree, keys[i], i);
+  }
+  double end = seconds();
+  print_row("insert", start, end);
+
+  start = seconds();
+  for (int i = 0; i < BENCH_KEYS; i++) {
+    sum += bpt_search(&tree, keys[i], &value);
+  }
+  end = seconds();
+  print_row("search", start, end);
+
+  start = seconds();
+  for (int i = 0; i < BENCH_KEYS; i++) {
+    sum += bpt_search(&tree, keys[i] - 1, &value);
+  }
+  end = seconds();
+  print_row("miss", start, end);
+
+  start = seconds();
+  bpt_inorder(&tree, sum_bpt, &sum);
+  end = seconds();
+  print_row("inorder", start, end);
+
+  start = seconds();
+  for (int i = 0; i < BENCH_KEYS; i++) {
+    bpt_delete(&tree, keys[i]);
+  }
+  end = seconds();
+  print_row("delete", start, end);
+  printf("\n");
+
+  bench_sink = sum;
+  bpt_dispose(&tree);
+}
+
+static void bench_bst(uint64_t *keys) {
+  bst_id_node_t *tree;
+  bst_id_init(&tree);
+  int value;
+  long sum = 0;
+
+  printf("[binary tree]\n");
+  double start = seconds();
+  for (int i = 0; i < BENCH_KEYS; i++) {
+    bst_id_insert(&tree, keys[i], i);
+  }
+  double end = seconds();
+  print_row("insert", start, end);
+
+  start = seconds();
+  for (int i = 0; i < BENCH_KEYS; i++) {
+    sum += bst_id_search(tree, keys[i], &value);
+  }
+  end = seconds();
+  print_row("search", start, end);
+
+  start = seconds();
+  for (int i = 0; i < BENCH_KEYS; i++) {
+    sum += bst_id_search(tree, keys[i] - 1, &value);
+  }
+  end = seconds();
+  print_row("miss", start, end);
+
+  start = seconds();
+  bst_id_inorder(tree, sum_bst, &sum);
+  end = seconds();
+  print_row("inorder", start, end);
+
+  start = seconds();
+  for (int i = 0; i < BENCH_KEYS; i++) {
+    bst_id_delete(&tree, keys[i]);
+  }
+  end = seconds();
+  print_row("delete", start, end);
+  printf("\n");
+
+  bench_sink = sum;
+  bst_id_dispose(&tree);
+}
+
+int main(int argc, char *argv[]) {
+  uint64_t *keys = (uint64_t *)malloc(BENCH_KEYS * sizeof(uint64_t));
+  for (int i = 0; i < BENCH_KEYS; i++) {
+    keys[i] = bench_key(i);
+  }
+
+  printf("%d random 64-bit keys, ns per key\n\n", BENCH_KEYS);
+  bench_bpt(keys);
+  bench_bst(keys);
+  free(keys);
+  return 0;
+}
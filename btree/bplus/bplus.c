@@ -0,0 +1,507 @@
+/*
+ * B+ strom
+ *
+ * Keys are routed by the separators of inner nodes: children[i] holds the
+ * keys smaller than keys[i] and children[i + 1] the keys from keys[i] on. A
+ * separator may stay after its key is deleted, it still routes correctly.
+ *
+ * Insert records the path from the root to the leaf and splits full nodes
+ * on the way back up; the nodes needed by the splits are allocated before
+ * anything changes, so a failed allocation leaves the tree as it was.
+ * Delete descends recursively (the depth is the height of the tree) and an
+ * underfull node borrows a key from a sibling or is merged with it.
+ */
+
+#include "bplus.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Every node but the root has BPT_MIN + 1 children or more, so 32 levels
+// hold more keys than memory can
+#define BPT_MAX_HEIGHT 32
+
+static void *bpt_alloc(size_t size)
+{
+  return aligned_alloc(BPT_ALIGN, (size + BPT_ALIGN - 1) / BPT_ALIGN * BPT_ALIGN);
+}
+
+static bpt_leaf_t *bpt_leaf_new(void)
+{
+  bpt_leaf_t *leaf = (bpt_leaf_t*)bpt_alloc(sizeof(bpt_leaf_t));
+  if (leaf == NULL) return NULL;
+
+  leaf->node.count = 0;
+  leaf->node.leaf = true;
+  leaf->next = NULL;
+  return leaf;
+}
+
+static bpt_inner_t *bpt_inner_new(void)
+{
+  bpt_inner_t *inner = (bpt_inner_t*)bpt_alloc(sizeof(bpt_inner_t));
+  if (inner == NULL) return NULL;
+
+  inner->node.count = 0;
+  inner->node.leaf = false;
+  return inner;
+}
+
+/*
+ * Number of keys smaller than key (lower) or not greater than key (upper).
+ * The keys are sorted, so the count is the position of key; counting all of
+ * them avoids a branch per key that a binary search would mispredict.
+ */
+static inline int bpt_lower(const bpt_node_t *node, bpt_key_t key)
+{
+  int pos = 0;
+  for (int i = 0; i < node->count; i++)
+    pos += node->keys[i] < key;
+  return pos;
+}
+
+static inline int bpt_upper(const bpt_node_t *node, bpt_key_t key)
+{
+  int pos = 0;
+  for (int i = 0; i < node->count; i++)
+    pos += node->keys[i] <= key;
+  return pos;
+}
+
+static bpt_leaf_t *bpt_find_leaf(bpt_node_t *node, bpt_key_t key)
+{
+  while (!node->leaf)
+    node = ((bpt_inner_t*)node)->children[bpt_upper(node, key)];
+  return (bpt_leaf_t*)node;
+}
+
+/*
+ * Inicializácia stromu.
+ */
+void bpt_init(bpt_tree_t *tree)
+{
+  if (tree == NULL) return;
+
+  tree->root = NULL;
+  tree->count = 0;
+  tree->height = 0;
+}
+
+/*
+ * Nájdenie kľúča v strome.
+ *
+ * V prípade úspechu vráti funkcia hodnotu true a do premennej value zapíše
+ * hodnotu kľúča. V opačnom prípade vráti false a value ostáva nezmenená.
+ */
+bool bpt_search(bpt_tree_t *tree, bpt_key_t key, int *value)
+{
+  if (tree == NULL || tree->root == NULL) return false;
+
+  bpt_leaf_t *leaf = bpt_find_leaf(tree->root, key);
+  int pos = bpt_lower(&leaf->node, key);
+  if (pos == leaf->node.count || leaf->node.keys[pos] != key)
+    return false;
+
+  *value = leaf->values[pos];
+  return true;
+}
+
+/*
+ * Adds key at pos of a leaf, splitting it into spare when it is full.
+ * Returns spare if it was used, with the smallest key of spare in *up.
+ */
+static bpt_node_t *bpt_leaf_insert(bpt_tree_t *tree, bpt_leaf_t *leaf,
+                                   bpt_key_t key, int value, int pos,
+                                   bpt_leaf_t *spare, bpt_key_t *up)
+{
+  bpt_node_t *node = &leaf->node;
+  tree->count++;
+
+  if (node->count < BPT_KEYS)
+  {
+    memmove(&node->keys[pos + 1], &node->keys[pos], (node->count - pos) * sizeof(bpt_key_t));
+    memmove(&leaf->values[pos + 1], &leaf->values[pos], (node->count - pos) * sizeof(int));
+    node->keys[pos] = key;
+    leaf->values[pos] = value;
+    node->count++;
+    return NULL;
+  }
+
+  // Split the BPT_KEYS + 1 keys in two halves
+  bpt_key_t keys[BPT_KEYS + 1];
+  int values[BPT_KEYS + 1];
+  memcpy(keys, node->keys, pos * sizeof(bpt_key_t));
+  memcpy(values, leaf->values, pos * sizeof(int));
+  keys[pos] = key;
+  values[pos] = value;
+  memcpy(&keys[pos + 1], &node->keys[pos], (BPT_KEYS - pos) * sizeof(bpt_key_t));
+  memcpy(&values[pos + 1], &leaf->values[pos], (BPT_KEYS - pos) * sizeof(int));
+
+  int left = (BPT_KEYS + 1) / 2;
+  int right = BPT_KEYS + 1 - left;
+  memcpy(node->keys, keys, left * sizeof(bpt_key_t));
+  memcpy(leaf->values, values, left * sizeof(int));
+  memcpy(spare->node.keys, &keys[left], right * sizeof(bpt_key_t));
+  memcpy(spare->values, &values[left], right * sizeof(int));
+  node->count = left;
+  spare->node.count = right;
+
+  spare->next = leaf->next;
+  leaf->next = spare;
+  *up = spare->node.keys[0];
+  return &spare->node;
+}
+
+/*
+ * Adds the separator and the new right child of children[pos] to an inner
+ * node, splitting it into spare when it is full. Returns spare if it was
+ * used, with the separator for the parent in *up.
+ */
+static bpt_node_t *bpt_inner_insert(bpt_inner_t *inner, int pos,
+                                    bpt_key_t separator, bpt_node_t *child,
+                                    bpt_inner_t *spare, bpt_key_t *up)
+{
+  bpt_node_t *node = &inner->node;
+
+  if (node->count < BPT_KEYS)
+  {
+    memmove(&node->keys[pos + 1], &node->keys[pos], (node->count - pos) * sizeof(bpt_key_t));
+    memmove(&inner->children[pos + 2], &inner->children[pos + 1],
+            (node->count - pos) * sizeof(bpt_node_t*));
+    node->keys[pos] = separator;
+    inner->children[pos + 1] = child;
+    node->count++;
+    return NULL;
+  }
+
+  bpt_key_t keys[BPT_KEYS + 1];
+  bpt_node_t *children[BPT_KEYS + 2];
+  memcpy(keys, node->keys, pos * sizeof(bpt_key_t));
+  memcpy(children, inner->children, (pos + 1) * sizeof(bpt_node_t*));
+  keys[pos] = separator;
+  children[pos + 1] = child;
+  memcpy(&keys[pos + 1], &node->keys[pos], (BPT_KEYS - pos) * sizeof(bpt_key_t));
+  memcpy(&children[pos + 2], &inner->children[pos + 1], (BPT_KEYS - pos) * sizeof(bpt_node_t*));
+
+  // The middle key moves up, each half keeps BPT_MIN keys
+  int left = BPT_KEYS / 2;
+  int right = BPT_KEYS - left;
+  memcpy(node->keys, keys, left * sizeof(bpt_key_t));
+  memcpy(inner->children, children, (left + 1) * sizeof(bpt_node_t*));
+  memcpy(spare->node.keys, &keys[left + 1], right * sizeof(bpt_key_t));
+  memcpy(spare->children, &children[left + 1], (right + 1) * sizeof(bpt_node_t*));
+  node->count = left;
+  spare->node.count = right;
+
+  *up = keys[left];
+  return &spare->node;
+}
+
+/*
+ * Vloženie kľúča do stromu.
+ *
+ * Pokiaľ kľúč v strome už existuje, nahradí sa jeho hodnota. If a node
+ * needed for a split cannot be allocated, the key is not inserted.
+ */
+void bpt_insert(bpt_tree_t *tree, bpt_key_t key, int value)
+{
+  if (tree == NULL) return;
+
+  if (tree->root == NULL)
+  {
+    bpt_leaf_t *leaf = bpt_leaf_new();
+    if (leaf == NULL) return;
+
+    leaf->node.keys[0] = key;
+    leaf->values[0] = value;
+    leaf->node.count = 1;
+    tree->root = &leaf->node;
+    tree->count = 1;
+    tree->height = 1;
+    return;
+  }
+
+  bpt_node_t *path[BPT_MAX_HEIGHT];
+  int positions[BPT_MAX_HEIGHT];
+  int leaf_level = tree->height - 1;
+  bpt_node_t *node = tree->root;
+  for (int level = 0; level < leaf_level; level++)
+  {
+    path[level] = node;
+    positions[level] = bpt_upper(node, key);
+    node = ((bpt_inner_t*)node)->children[positions[level]];
+  }
+  path[leaf_level] = node;
+
+  bpt_leaf_t *leaf = (bpt_leaf_t*)node;
+  int pos = bpt_lower(node, key);
+  if (pos < node->count && node->keys[pos] == key)
+  {
+    leaf->values[pos] = value;
+    return;
+  }
+
+  // The full nodes at the bottom of the path split, the root may need a
+  // parent; allocate all of them first
+  int first = leaf_level + 1;
+  while (first > 0 && path[first - 1]->count == BPT_KEYS)
+    first--;
+
+  bpt_node_t *spares[BPT_MAX_HEIGHT];
+  bpt_inner_t *root = NULL;
+  bool ok = first > 0 || (root = bpt_inner_new()) != NULL;
+  for (int level = first; level <= leaf_level; level++)
+  {
+    spares[level] = level == leaf_level ? (bpt_node_t*)bpt_leaf_new()
+                                        : (bpt_node_t*)bpt_inner_new();
+    ok = ok && spares[level] != NULL;
+  }
+  if (!ok)
+  {
+    for (int level = first; level <= leaf_level; level++)
+      free(spares[level]);
+    free(root);
+    return;
+  }
+
+  bpt_key_t separator;
+  bpt_node_t *right = bpt_leaf_insert(tree, leaf, key, value, pos,
+                                      first <= leaf_level ? (bpt_leaf_t*)spares[leaf_level] : NULL,
+                                      &separator);
+  for (int level = leaf_level - 1; right != NULL && level >= 0; level--)
+  {
+    right = bpt_inner_insert((bpt_inner_t*)path[level], positions[level], separator,
+                             right, level >= first ? (bpt_inner_t*)spares[level] : NULL,
+                             &separator);
+  }
+
+  if (right != NULL)
+  {
+    root->node.keys[0] = separator;
+    root->children[0] = tree->root;
+    root->children[1] = right;
+    root->node.count = 1;
+    tree->root = &root->node;
+    tree->height++;
+  }
+}
+
+/*
+ * Moves one key from a sibling to children[pos] of an inner node, which has
+ * BPT_MIN - 1 keys, if a sibling can spare one.
+ */
+static bool bpt_borrow(bpt_inner_t *parent, int pos)
+{
+  bpt_node_t *child = parent->children[pos];
+  bpt_node_t *left = pos > 0 ? parent->children[pos - 1] : NULL;
+  bpt_node_t *right = pos < parent->node.count ? parent->children[pos + 1] : NULL;
+
+  if (left != NULL && left->count > BPT_MIN)
+  {
+    memmove(&child->keys[1], child->keys, child->count * sizeof(bpt_key_t));
+    if (child->leaf)
+    {
+      bpt_leaf_t *leaf = (bpt_leaf_t*)child;
+      memmove(&leaf->values[1], leaf->values, child->count * sizeof(int));
+      child->keys[0] = left->keys[left->count - 1];
+      leaf->values[0] = ((bpt_leaf_t*)left)->values[left->count - 1];
+      parent->node.keys[pos - 1] = child->keys[0];
+    }
+    else
+    {
+      // The separator comes down, the last key of left goes up
+      bpt_inner_t *inner = (bpt_inner_t*)child;
+      memmove(&inner->children[1], inner->children, (child->count + 1) * sizeof(bpt_node_t*));
+      child->keys[0] = parent->node.keys[pos - 1];
+      inner->children[0] = ((bpt_inner_t*)left)->children[left->count];
+      parent->node.keys[pos - 1] = left->keys[left->count - 1];
+    }
+    left->count--;
+    child->count++;
+    return true;
+  }
+
+  if (right != NULL && right->count > BPT_MIN)
+  {
+    if (child->leaf)
+    {
+      bpt_leaf_t *leaf = (bpt_leaf_t*)child;
+      bpt_leaf_t *next = (bpt_leaf_t*)right;
+      child->keys[child->count] = right->keys[0];
+      leaf->values[child->count] = next->values[0];
+      memmove(next->values, &next->values[1], (right->count - 1) * sizeof(int));
+      memmove(right->keys, &right->keys[1], (right->count - 1) * sizeof(bpt_key_t));
+      parent->node.keys[pos] = right->keys[0];
+    }
+    else
+    {
+      bpt_inner_t *inner = (bpt_inner_t*)child;
+      bpt_inner_t *next = (bpt_inner_t*)right;
+      child->keys[child->count] = parent->node.keys[pos];
+      inner->children[child->count + 1] = next->children[0];
+      parent->node.keys[pos] = right->keys[0];
+      memmove(right->keys, &right->keys[1], (right->count - 1) * sizeof(bpt_key_t));
+      memmove(next->children, &next->children[1], right->count * sizeof(bpt_node_t*));
+    }
+    right->count--;
+    child->count++;
+    return true;
+  }
+
+  return false;
+}
+
+/*
+ * Merges children[pos + 1] of an inner node into children[pos] and removes
+ * it with its separator. Together they hold at most BPT_KEYS keys.
+ */
+static void bpt_merge(bpt_inner_t *parent, int pos)
+{
+  bpt_node_t *left = parent->children[pos];
+  bpt_node_t *right = parent->children[pos + 1];
+
+  if (left->leaf)
+  {
+    memcpy(&left->keys[left->count], right->keys, right->count * sizeof(bpt_key_t));
+    memcpy(&((bpt_leaf_t*)left)->values[left->count], ((bpt_leaf_t*)right)->values,
+           right->count * sizeof(int));
+    left->count += right->count;
+    ((bpt_leaf_t*)left)->next = ((bpt_leaf_t*)right)->next;
+  }
+  else
+  {
+    left->keys[left->count] = parent->node.keys[pos];
+    memcpy(&left->keys[left->count + 1], right->keys, right->count * sizeof(bpt_key_t));
+    memcpy(&((bpt_inner_t*)left)->children[left->count + 1], ((bpt_inner_t*)right)->children,
+           (right->count + 1) * sizeof(bpt_node_t*));
+    left->count += right->count + 1;
+  }
+  free(right);
+
+  bpt_node_t *node = &parent->node;
+  memmove(&node->keys[pos], &node->keys[pos + 1], (node->count - pos - 1) * sizeof(bpt_key_t));
+  memmove(&parent->children[pos + 1], &parent->children[pos + 2],
+          (node->count - pos - 1) * sizeof(bpt_node_t*));
+  node->count--;
+}
+
+/*
+ * Deletes key below node and repairs an underfull child. Returns false if
+ * the key was not there.
+ */
+static bool bpt_delete_node(bpt_tree_t *tree, bpt_node_t *node, bpt_key_t key)
+{
+  if (node->leaf)
+  {
+    bpt_leaf_t *leaf = (bpt_leaf_t*)node;
+    int pos = bpt_lower(node, key);
+    if (pos == node->count || node->keys[pos] != key)
+      return false;
+
+    memmove(&node->keys[pos], &node->keys[pos + 1], (node->count - pos - 1) * sizeof(bpt_key_t));
+    memmove(&leaf->values[pos], &leaf->values[pos + 1], (node->count - pos - 1) * sizeof(int));
+    node->count--;
+    tree->count--;
+    return true;
+  }
+
+  bpt_inner_t *inner = (bpt_inner_t*)node;
+  int pos = bpt_upper(node, key);
+  if (!bpt_delete_node(tree, inner->children[pos], key))
+    return false;
+
+  if (inner->children[pos]->count < BPT_MIN && !bpt_borrow(inner, pos))
+    bpt_merge(inner, pos > 0 ? pos - 1 : pos);
+  return true;
+}
+
+/*
+ * Odstránenie kľúča zo stromu.
+ *
+ * Pokiaľ kľúč neexistuje, funkcia nič nerobí. A root left with a single
+ * child is replaced by it, so the tree shrinks by a level.
+ */
+void bpt_delete(bpt_tree_t *tree, bpt_key_t key)
+{
+  if (tree == NULL || tree->root == NULL) return;
+  if (!bpt_delete_node(tree, tree->root, key)) return;
+
+  bpt_node_t *root = tree->root;
+  if (root->count > 0) return;
+
+  tree->root = root->leaf ? NULL : ((bpt_inner_t*)root)->children[0];
+  tree->height--;
+  free(root);
+}
+
+static void bpt_dispose_node(bpt_node_t *node)
+{
+  if (!node->leaf)
+  {
+    for (int i = 0; i <= node->count; i++)
+      bpt_dispose_node(((bpt_inner_t*)node)->children[i]);
+  }
+  free(node);
+}
+
+/*
+ * Zrušenie celého stromu.
+ *
+ * Po zrušení sa strom nachádza v rovnakom stave ako po inicializácii.
+ */
+void bpt_dispose(bpt_tree_t *tree)
+{
+  if (tree == NULL) return;
+
+  if (tree->root != NULL)
+    bpt_dispose_node(tree->root);
+  bpt_init(tree);
+}
+
+/*
+ * Inorder prechod stromom.
+ *
+ * Calls visit for every key in ascending order, walking the linked leaves.
+ */
+void bpt_inorder(bpt_tree_t *tree, bpt_visit_t visit, void *data)
+{
+  if (tree == NULL || tree->root == NULL) return;
+
+  bpt_node_t *node = tree->root;
+  while (!node->leaf)
+    node = ((bpt_inner_t*)node)->children[0];
+
+  for (bpt_leaf_t *leaf = (bpt_leaf_t*)node; leaf != NULL; leaf = leaf->next)
+  {
+    for (int i = 0; i < leaf->node.count; i++)
+      visit(leaf->node.keys[i], leaf->values[i], data);
+  }
+}
+
+/*
+ * Prechod kľúčmi z intervalu.
+ *
+ * Calls visit for every key from from to to, both included, in ascending
+ * order. visit may be NULL to only count the keys. Returns the number of
+ * keys in the range.
+ */
+size_t bpt_range(bpt_tree_t *tree, bpt_key_t from, bpt_key_t to,
+                 bpt_visit_t visit, void *data)
+{
+  if (tree == NULL || tree->root == NULL || from > to) return 0;
+
+  size_t count = 0;
+  bpt_leaf_t *leaf = bpt_find_leaf(tree->root, from);
+  int pos = bpt_lower(&leaf->node, from);
+  for (; leaf != NULL; leaf = leaf->next, pos = 0)
+  {
+    for (; pos < leaf->node.count; pos++)
+    {
+      if (leaf->node.keys[pos] > to) return count;
+
+      if (visit != NULL)
+        visit(leaf->node.keys[pos], leaf->values[pos], data);
+      count++;
+    }
+  }
+  return count;
+}
@@ -0,0 +1,75 @@
+/*
+ * Hlavičkový súbor pre B+ strom.
+ *
+ * A B+ tree with 64-bit keys and the operations of btree.h plus ordered
+ * range scans. A node holds up to BPT_KEYS sorted keys in one array that
+ * starts on a cache line, so a lookup touches a few lines per level instead
+ * of one separately allocated node per comparison, and the tree is about
+ * log(n) / log(BPT_KEYS / 2) levels high. Keys are searched by counting the
+ * keys smaller than the key in a loop without data-dependent branches,
+ * which the compiler can vectorize.
+ *
+ * Values live only in the leaves, which are linked in key order; inorder
+ * traversals and range scans walk the leaves sequentially. Every node
+ * except the root holds at least BPT_MIN keys.
+ */
+
+#ifndef IAL_BTREE_BPLUS_H
+#define IAL_BTREE_BPLUS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Najväčší počet kľúčov v uzle, 32 kľúčov zaberá 4 riadky cache
+#define BPT_KEYS 32
+
+// Najmenší počet kľúčov v uzle okrem koreňa
+#define BPT_MIN (BPT_KEYS / 2)
+
+// Zarovnanie uzlov
+#define BPT_ALIGN 64
+
+typedef uint64_t bpt_key_t;
+
+// Spoločná časť uzlov
+typedef struct bpt_node {
+  bpt_key_t keys[BPT_KEYS]; // zoradené kľúče
+  int count;                // počet kľúčov
+  bool leaf;                // uzol je list
+} bpt_node_t;
+
+// Vnútorný uzol, children[i] obsahuje kľúče menšie ako keys[i]
+typedef struct bpt_inner {
+  bpt_node_t node;
+  bpt_node_t *children[BPT_KEYS + 1];
+} bpt_inner_t;
+
+// List s hodnotami
+typedef struct bpt_leaf {
+  bpt_node_t node;
+  int values[BPT_KEYS];  // hodnoty ku kľúčom
+  struct bpt_leaf *next; // list s nasledujúcimi kľúčmi
+} bpt_leaf_t;
+
+// Strom
+typedef struct bpt_tree {
+  bpt_node_t *root; // koreň, NULL pre prázdny strom
+  size_t count;     // počet kľúčov
+  int height;       // počet úrovní, 0 pre prázdny strom
+} bpt_tree_t;
+
+// Funkcia volaná pre každý prvok pri prechode
+typedef void (*bpt_visit_t)(bpt_key_t key, int value, void *data);
+
+void bpt_init(bpt_tree_t *tree);
+void bpt_insert(bpt_tree_t *tree, bpt_key_t key, int value);
+bool bpt_search(bpt_tree_t *tree, bpt_key_t key, int *value);
+void bpt_delete(bpt_tree_t *tree, bpt_key_t key);
+void bpt_dispose(bpt_tree_t *tree);
+
+void bpt_inorder(bpt_tree_t *tree, bpt_visit_t visit, void *data);
+size_t bpt_range(bpt_tree_t *tree, bpt_key_t from, bpt_key_t to,
+                 bpt_visit_t visit, void *data);
+
+#endif
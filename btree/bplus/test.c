@@ -0,0 +1,120 @@
+/*
+ * Test of the B+ tree (bplus.c). The output is compared with bplus.out.
+ */
+
+#include "bplus.h"
+#include <inttypes.h>
+#include <stdio.h>
+
+#define TEST_KEYS 10000
+
+void print_item(bpt_key_t key, int value, void *data) {
+  printf("[%" PRIu64 ",%d]", key, value);
+}
+
+void check_order(bpt_key_t key, int value, void *data) {
+  bpt_key_t *last = (bpt_key_t *)data;
+  if (key <= last[0] && last[1] > 0) {
+    printf("Order broken at %" PRIu64 "\n", key);
+  }
+  last[0] = key;
+  last[1]++;
+}
+
+void print_tree(bpt_tree_t *tree) {
+  bpt_key_t last[2] = {0, 0};
+  bpt_inorder(tree, check_order, last);
+  printf("Keys: %zu, visited: %" PRIu64 ", height: %d\n", tree->count,
+         last[1], tree->height);
+}
+
+// Keys 0, 3, 6, ... in a scrambled order
+bpt_key_t test_key(int i) {
+  return (bpt_key_t)((i * 7919L) % TEST_KEYS) * 3;
+}
+
+void test_small() {
+  printf("[test_small] A single leaf\n");
+  bpt_tree_t tree;
+  bpt_init(&tree);
+  int result = 0;
+  printf("Search in an empty tree: %s\n",
+         bpt_search(&tree, 1, &result) ? "true" : "false");
+
+  bpt_key_t keys[] = {8, 4, 12, 2, 6, 10, 14, 1};
+  for (int i = 0; i < 8; i++) {
+    bpt_insert(&tree, keys[i], i);
+  }
+  bpt_insert(&tree, 6, 60);
+  bpt_delete(&tree, 2);
+  bpt_delete(&tree, 3);
+  bpt_inorder(&tree, print_item, NULL);
+  printf("\n");
+  printf("Search 6: %s", bpt_search(&tree, 6, &result) ? "true" : "false");
+  printf(" %d\n", result);
+  bpt_dispose(&tree);
+  printf("Disposed: %s\n\n", tree.root == NULL ? "true" : "false");
+}
+
+void test_many() {
+  printf("[test_many] Insert and delete %d keys\n", TEST_KEYS);
+  bpt_tree_t tree;
+  bpt_init(&tree);
+  for (int i = 0; i < TEST_KEYS; i++) {
+    bpt_insert(&tree, test_key(i), i);
+  }
+  print_tree(&tree);
+
+  int found = 0, missing = 0, result;
+  for (int i = 0; i < TEST_KEYS; i++) {
+    found += bpt_search(&tree, test_key(i), &result) && result == i;
+    missing += bpt_search(&tree, test_key(i) + 1, &result);
+  }
+  printf("Found: %d, found missing: %d\n", found, missing);
+
+  printf("Range [100, 130]: ");
+  size_t count = bpt_range(&tree, 100, 130, print_item, NULL);
+  printf("\nIn range: %zu, in [0, 2^64 - 1]: %zu\n", count,
+         bpt_range(&tree, 0, UINT64_MAX, NULL, NULL));
+
+  for (int i = 0; i < TEST_KEYS; i += 2) {
+    bpt_delete(&tree, test_key(i));
+  }
+  print_tree(&tree);
+  found = 0;
+  for (int i = 0; i < TEST_KEYS; i++) {
+    found += bpt_search(&tree, test_key(i), &result);
+  }
+  printf("Found: %d\n", found);
+
+  for (int i = 0; i < TEST_KEYS; i++) {
+    bpt_delete(&tree, test_key(i));
+  }
+  print_tree(&tree);
+  bpt_dispose(&tree);
+  printf("\n");
+}
+
+void test_sorted() {
+  printf("[test_sorted] Insert keys in ascending order\n");
+  bpt_tree_t tree;
+  bpt_init(&tree);
+  for (int i = 0; i < TEST_KEYS; i++) {
+    bpt_insert(&tree, i, i);
+  }
+  print_tree(&tree);
+  printf("Range [9990, 20000]: %zu\n",
+         bpt_range(&tree, 9990, 20000, NULL, NULL));
+  bpt_dispose(&tree);
+  printf("\n");
+}
+
+int main(int argc, char *argv[]) {
+  printf("B+ Tree - testing script\n");
+  printf("------------------------\n");
+  printf("\n");
+
+  test_small();
+  test_many();
+  test_sorted();
+}
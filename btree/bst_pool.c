@@ -0,0 +1,198 @@
+/*
+ * Zásobník uzlov stromu
+ *
+ * Slabs are filled from the start; the newest slab of a pool is the first
+ * in its list and the only one with unused space. A freed node goes to the
+ * free list, linked through its left pointer, and is handed out again before
+ * the unused space. When the last node of a pool is freed the tree is empty
+ * and the pool goes away with its slabs.
+ */
+
+#include "bst_pool.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+typedef struct bst_pool bst_pool_t;
+
+// Hlavička bloku uzlov
+typedef struct bst_slab {
+  bst_pool_t *pool;      // zásobník, ktorému blok patrí
+  struct bst_slab *next; // starší blok
+} bst_slab_t;
+
+// Zásobník uzlov jedného stromu
+struct bst_pool {
+  bst_slab_t *slabs; // bloky, najnovší prvý
+  bst_node_t *free;  // uvoľnené uzly spojené cez left
+  size_t unused;     // počet nepoužitých uzlov na konci najnovšieho bloku
+  size_t live;       // počet uzlov v strome
+  bst_node_t *root;  // koreň stromu
+};
+
+// Nodes start after the header, at the alignment of a node
+#define BST_SLAB_FIRST                                                        \
+  ((sizeof(bst_slab_t) + sizeof(bst_node_t) - 1) / sizeof(bst_node_t))
+#define BST_SLAB_NODES (BST_SLAB_SIZE / sizeof(bst_node_t) - BST_SLAB_FIRST)
+
+static bst_pool_t *bst_pool_of(bst_node_t *node)
+{
+  return ((bst_slab_t*)((uintptr_t)node & ~(uintptr_t)(BST_SLAB_SIZE - 1)))->pool;
+}
+
+static bst_node_t *bst_slab_nodes(bst_slab_t *slab)
+{
+  return (bst_node_t*)slab + BST_SLAB_FIRST;
+}
+
+static bool bst_pool_grow(bst_pool_t *pool)
+{
+  bst_slab_t *slab = (bst_slab_t*)aligned_alloc(BST_SLAB_SIZE, BST_SLAB_SIZE);
+  if (slab == NULL) return false;
+
+  slab->pool = pool;
+  slab->next = pool->slabs;
+  pool->slabs = slab;
+  pool->unused = BST_SLAB_NODES;
+  return true;
+}
+
+/*
+ * Alokácia uzlu.
+ *
+ * tree is any node of the tree the new node is going to be part of, or NULL
+ * for the first node of a new tree, which gets a new pool. Returns a leaf
+ * with key and value, or NULL if memory runs out.
+ */
+bst_node_t *bst_pool_alloc(bst_node_t *tree, char key, int value)
+{
+  bst_pool_t *pool;
+  if (tree != NULL)
+  {
+    pool = bst_pool_of(tree);
+  }
+  else
+  {
+    pool = (bst_pool_t*)malloc(sizeof(bst_pool_t));
+    if (pool == NULL) return NULL;
+
+    pool->slabs = NULL;
+    pool->free = NULL;
+    pool->unused = 0;
+    pool->live = 0;
+    pool->root = NULL;
+  }
+
+  bst_node_t *node = pool->free;
+  if (node != NULL)
+  {
+    pool->free = node->left;
+  }
+  else if (pool->unused > 0 || bst_pool_grow(pool))
+  {
+    node = bst_slab_nodes(pool->slabs) + (BST_SLAB_NODES - pool->unused);
+    pool->unused--;
+  }
+  else
+  {
+    if (pool->live == 0)
+      free(pool);
+    return NULL;
+  }
+
+  pool->live++;
+  if (tree == NULL)
+    pool->root = node;
+  node->key = key;
+  node->value = value;
+  node->left = NULL;
+  node->right = NULL;
+  return node;
+}
+
+static void bst_pool_release(bst_pool_t *pool)
+{
+  while (pool->slabs != NULL)
+  {
+    bst_slab_t *next = pool->slabs->next;
+    free(pool->slabs);
+    pool->slabs = next;
+  }
+  free(pool);
+}
+
+/*
+ * Uvoľnenie uzlu.
+ *
+ * The node is kept for the next insert into the same tree. Freeing the last
+ * node of a tree frees its pool.
+ */
+void bst_pool_free(bst_node_t *node)
+{
+  if (node == NULL) return;
+
+  bst_pool_t *pool = bst_pool_of(node);
+  if (--pool->live == 0)
+  {
+    bst_pool_release(pool);
+    return;
+  }
+
+  node->left = pool->free;
+  pool->free = node;
+}
+
+/*
+ * Odstránenie uzlu nahradeného v strome jeho potomkom.
+ *
+ * Like bst_pool_free, for a node whose place in the tree child takes (NULL
+ * for a leaf). If node is the root of the tree, child becomes the root that
+ * bst_pool_dispose recognizes.
+ */
+void bst_pool_remove(bst_node_t *node, bst_node_t *child)
+{
+  if (node == NULL) return;
+
+  bst_pool_t *pool = bst_pool_of(node);
+  if (pool->root == node)
+    pool->root = child;
+  bst_pool_free(node);
+}
+
+/*
+ * Uvoľnenie všetkých uzlov podstromu.
+ *
+ * tree is the root of the whole tree or of a subtree. The whole tree frees
+ * its slabs at once, in time proportional to their number and without
+ * visiting a node. The nodes of a subtree go to the free list one by one,
+ * left children are rotated up so the walk needs no stack, and the rest of
+ * the tree stays valid.
+ */
+void bst_pool_dispose(bst_node_t *tree)
+{
+  if (tree == NULL) return;
+
+  bst_pool_t *pool = bst_pool_of(tree);
+  if (tree == pool->root)
+  {
+    bst_pool_release(pool);
+    return;
+  }
+
+  bst_node_t *node = tree;
+  while (node != NULL)
+  {
+    if (node->left != NULL)
+    {
+      bst_node_t *left = node->left;
+      node->left = left->right;
+      left->right = node;
+      node = left;
+    }
+    else
+    {
+      bst_node_t *right = node->right;
+      bst_pool_free(node);
+      node = right;
+    }
+  }
+}
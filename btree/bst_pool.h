@@ -0,0 +1,33 @@
+/*
+ * Hlavičkový súbor pre zásobník uzlov stromu.
+ *
+ * Every tree of the rec and iter variants takes its nodes from a pool of its
+ * own, created with the first node. The pool carves nodes out of slabs of
+ * BST_SLAB_SIZE bytes and keeps deleted nodes on a free list, so insert and
+ * delete rarely reach malloc and free, and bst_dispose of a whole tree gives
+ * the slabs back instead of freeing every node. A disposed subtree only
+ * returns its nodes to the pool. To tell the two apart the pool remembers the
+ * root of its tree, and bst_delete hands removed nodes over through
+ * bst_pool_remove so that a new root is recorded.
+ *
+ * The tree has no place for a pointer to its pool (btree.h is fixed), so the
+ * slabs are aligned to their size and begin with a header pointing to the
+ * pool: any node of a tree leads to the pool of that tree. Even a tree of
+ * one node takes a whole slab.
+ */
+
+#ifndef IAL_BTREE_BST_POOL_H
+#define IAL_BTREE_BST_POOL_H
+
+#include "btree.h"
+#include <stddef.h>
+
+// Veľkosť a zarovnanie jedného bloku uzlov, mocnina dvoch
+#define BST_SLAB_SIZE 16384
+
+bst_node_t *bst_pool_alloc(bst_node_t *tree, char key, int value);
+void bst_pool_free(bst_node_t *node);
+void bst_pool_remove(bst_node_t *node, bst_node_t *child);
+void bst_pool_dispose(bst_node_t *tree);
+
+#endif
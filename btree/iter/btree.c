@@ -7,9 +7,9 @@
  */
 
 #include "../btree.h"
+#include "../bst_pool.h"
 #include "stack.h"
 #include <stdio.h>
-#include <stdlib.h>
 
 /*
  * Inicializácia stromu.
@@ -78,14 +78,8 @@ void bst_insert(bst_node_t **tree, char key, int value)
   
   if (*tree == NULL)
   {
-    // Tree is empty so create first node
-    *tree = (bst_node_t*)malloc(sizeof(bst_node_t));
-    if (*tree == NULL) return;
-
-    (*tree)->key = key;
-    (*tree)->value = value;
-    (*tree)->left = NULL;
-    (*tree)->right = NULL;
+    // Tree is empty so create first node with a new pool
+    *tree = bst_pool_alloc(NULL, key, value);
   }
   else
   {
@@ -118,27 +112,13 @@ void bst_insert(bst_node_t **tree, char key, int value)
 
     if (key < current->key)
     {
-      // Insert left
-      current->left = (bst_node_t*)malloc(sizeof(bst_node_t));
-      if (current->left == NULL) return;
-
-      current->left->key = key;
-      current->left->value = value;
-
-      current->left->left = NULL;
-      current->left->right = NULL;
+      // Insert left, the node comes from the pool of the tree
+      current->left = bst_pool_alloc(current, key, value);
     }
     else 
     {
       // Insert right
-      current->right = (bst_node_t*)malloc(sizeof(bst_node_t));
-      if (current->right == NULL) return;
-
-      current->right->key = key;
-      current->right->value = value;
-
-      current->right->left = NULL;
-      current->right->right = NULL;
+      current->right = bst_pool_alloc(current, key, value);
     }
   }
 }
@@ -172,10 +152,13 @@ void bst_replace_by_rightmost(bst_node_t *target, bst_node_t **tree)
 
   if (prev != NULL)
     prev->right = current->left;
+  else
+    // the root of the subtree is the rightmost node itself
+    *tree = current->left;
 
   target->key = current->key;
   target->value = current->value;
-  free(current);
+  bst_pool_free(current);
 }
 
 /*
@@ -236,7 +219,7 @@ void bst_delete(bst_node_t **tree, char key)
         // its core node so replace it
         *tree = NULL;
 
-      free(current);
+      bst_pool_remove(current, NULL);
     }
     else if (current->left != NULL && current->right == NULL)
     {
@@ -254,7 +237,7 @@ void bst_delete(bst_node_t **tree, char key)
         // its core node so replace it
         *tree = current->left;
 
-      free(current);
+      bst_pool_remove(current, current->left);
     }
     else if (current->left == NULL && current->right != NULL)
     {
@@ -272,7 +255,7 @@ void bst_delete(bst_node_t **tree, char key)
         // its core node so replace it
         *tree = current->right;
 
-      free(current);
+      bst_pool_remove(current, current->right);
     }
     else
     {
@@ -289,37 +272,16 @@ void bst_delete(bst_node_t **tree, char key)
  * inicializácii. Funkcia korektne uvoľní všetky alokované zdroje rušených
  * uzlov.
  *
- * Funkciu implementujte iteratívne pomocou zásobníku uzlov a bez použitia
- * vlastných pomocných funkcií.
+ * tree may also point to a subtree, which is disposed alone. All nodes come
+ * from the pool of the tree; disposing the whole tree frees the pool at once
+ * and a subtree gives its nodes back to it (see bst_pool_dispose).
  */
 void bst_dispose(bst_node_t **tree) 
 {
   if (tree == NULL) return;
   if (*tree == NULL) return;
 
-  // stack of nodes need to be go thru for dispose
-  stack_bst_t toDisposeStack;
-  stack_bst_init(&toDisposeStack);
-
-  // push core node to stack
-  stack_bst_push(&toDisposeStack, *tree);
-
-  // iterate until stack is empty
-  while (!stack_bst_empty(&toDisposeStack))
-  {
-    // get top of the stack
-    bst_node_t *current = stack_bst_pop(&toDisposeStack);
-
-    // if current node have left or right branch then add it to stack
-    if (current->left != NULL)
-      stack_bst_push(&toDisposeStack, current->left);
-
-    if (current->right != NULL)
-      stack_bst_push(&toDisposeStack, current->right);
-
-    // dispose current node
-    free(current);
-  }
+  bst_pool_dispose(*tree);
 
   // clear pointer to core node
   *tree = NULL;
@@ -338,6 +300,10 @@ void bst_leftmost_preorder(bst_node_t *tree, stack_bst_t *to_visit)
 {
   if (tree == NULL) return;
 
+  // Right branches are gathered in chunks, each pushed to the stack at once
+  bst_node_t *right[STACK_INLINE];
+  int count = 0;
+
   bst_node_t *current = tree;
   while (current != NULL)
   {
@@ -346,11 +312,20 @@ void bst_leftmost_preorder(bst_node_t *tree, stack_bst_t *to_visit)
 
     // if node have right branch add it to processing later
     if (current->right != NULL)
-      stack_bst_push(to_visit, current->right);
+    {
+      right[count++] = current->right;
+      if (count == STACK_INLINE)
+      {
+        stack_bst_push_many(to_visit, right, count);
+        count = 0;
+      }
+    }
 
     // go to next left node
     current = current->left;
   }
+
+  stack_bst_push_many(to_visit, right, count);
 }
 
 /*
@@ -378,6 +353,9 @@ void bst_preorder(bst_node_t *tree)
     // go thru each node on stack and go thru it from left
     bst_leftmost_preorder(stack_bst_pop(&toVisitStack), &toVisitStack);
   }
+
+  // free the heap buffer of a deep tree
+  stack_bst_dispose(&toVisitStack);
 }
 
 /*
@@ -393,13 +371,24 @@ void bst_leftmost_inorder(bst_node_t *tree, stack_bst_t *to_visit)
 {
   if (tree == NULL) return;
 
+  // The branch is gathered in chunks, each pushed to the stack at once
+  bst_node_t *branch[STACK_INLINE];
+  int count = 0;
+
   bst_node_t *current = tree;
   while (current != NULL)
   {
     // Add all left nodes on current branch to stack
-    stack_bst_push(to_visit, current);
+    branch[count++] = current;
+    if (count == STACK_INLINE)
+    {
+      stack_bst_push_many(to_visit, branch, count);
+      count = 0;
+    }
     current = current->left;
   }
+
+  stack_bst_push_many(to_visit, branch, count);
 }
 
 /*
@@ -453,6 +442,8 @@ void bst_inorder(bst_node_t *tree)
       bst_leftmost_inorder(current->right, &toVisitStack);
     }
   }
+
+  stack_bst_dispose(&toVisitStack);
 }
 
 /*
@@ -470,14 +461,28 @@ void bst_leftmost_postorder(bst_node_t *tree, stack_bst_t *to_visit,
 {
   if (tree == NULL) return;
 
+  // The branch and its flags are gathered in chunks, each pushed at once
+  bst_node_t *branch[STACK_INLINE];
+  bool first[STACK_INLINE];
+  int count = 0;
+
   bst_node_t *current = tree;
   while (current != NULL)
   {
     // Go thru most left branch, add its nodes to stack and mark it as first visited
-    stack_bst_push(to_visit, current);
-    stack_bool_push(first_visit, true);
+    branch[count] = current;
+    first[count++] = true;
+    if (count == STACK_INLINE)
+    {
+      stack_bst_push_many(to_visit, branch, count);
+      stack_bool_push_many(first_visit, first, count);
+      count = 0;
+    }
     current = current->left;
   }
+
+  stack_bst_push_many(to_visit, branch, count);
+  stack_bool_push_many(first_visit, first, count);
 }
 
 /*
@@ -524,4 +529,7 @@ void bst_postorder(bst_node_t *tree)
       bst_print_node(stack_bst_pop(&toVisitStack));
     }
   }
+
+  stack_bst_dispose(&toVisitStack);
+  stack_bool_dispose(&firstVisitFlagStack);
 }
@@ -1,37 +1,54 @@
 /*
  * Hlavičkový súbor pre pomocné zásobníky.
- * Tento súbor neupravujte.
  */
 #ifndef IAL_BTREE_ITER_STACK_H
 #define IAL_BTREE_ITER_STACK_H
 
 #include "../btree.h"
 
-// Maximálna veľkosť zásobníku
-#define MAXSTACK 30
+// Počet prvkov uložených priamo v zásobníku, ďalšie idú na haldu
+#define STACK_INLINE 30
 
 /*
  * Makro generujúce deklarácie pre zásobník typu T s názvovým infixom TNAME.
  * Pre TNAME="bst" pracujúce s typom T="bst_node_t*":
  *   Dátový typ stack_bst_t
  *   Funkcie void stack_bst_init(stack_bst_t *stack)
+ *           void stack_bst_dispose(stack_bst_t *stack)
  *           void stack_bst_push(stack_bst_t *stack, bst_node_t *item)
  *           bst_node_t *stack_bst_pop(stack_bst_t *stack)
  *           bst_node_t *stack_bst_top(stack_bst_t *stack)
  *           bool stack_bst_empty(stack_bst_t *stack)
+ *           bool stack_bst_reserve(stack_bst_t *stack, int count)
+ *           void stack_bst_push_many(stack_bst_t *stack,
+ *                                    bst_node_t *const *items, int count)
  * A ekvivalent pre TNAME="bool", T="bool".
+ *
+ * The first STACK_INLINE items are stored in the stack itself. Beyond that
+ * the items move to a heap buffer that doubles when full, so a stack holds
+ * any number of items and stack_*_dispose must free it. An initialized stack
+ * must not be copied, items may point into it. push_many pushes items in
+ * their order (the last one ends on top) after making room for all of them
+ * at once. There is no pop_many: the traversals pop one item at a time,
+ * since each popped item decides what happens next.
  */
 #define STACKDEC(T, TNAME)                                                     \
   typedef struct {                                                             \
-    T items[MAXSTACK];                                                         \
+    T *items;                                                                  \
     int top;                                                                   \
+    int capacity;                                                              \
+    T inline_items[STACK_INLINE];                                              \
   } stack_##TNAME##_t;                                                         \
                                                                                \
   void stack_##TNAME##_init(stack_##TNAME##_t *stack);                         \
+  void stack_##TNAME##_dispose(stack_##TNAME##_t *stack);                      \
   void stack_##TNAME##_push(stack_##TNAME##_t *stack, T item);                 \
   T stack_##TNAME##_pop(stack_##TNAME##_t *stack);                             \
   T stack_##TNAME##_top(stack_##TNAME##_t *stack);                             \
-  bool stack_##TNAME##_empty(stack_##TNAME##_t *stack);
+  bool stack_##TNAME##_empty(stack_##TNAME##_t *stack);                        \
+  bool stack_##TNAME##_reserve(stack_##TNAME##_t *stack, int count);           \
+  void stack_##TNAME##_push_many(stack_##TNAME##_t *stack, T const *items,     \
+                                 int count);
 
 STACKDEC(bst_node_t *, bst)
 STACKDEC(bool, bool)
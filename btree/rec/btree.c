@@ -6,8 +6,8 @@
  */
 
 #include "../btree.h"
+#include "../bst_pool.h"
 #include <stdio.h>
-#include <stdlib.h>
 
 /*
  * Inicializácia stromu.
@@ -75,14 +75,8 @@ void bst_insert(bst_node_t **tree, char key, int value)
 
   if (*tree == NULL)
   {
-    // Tree is empty so create first node
-    *tree = (bst_node_t*)malloc(sizeof(bst_node_t));
-    if (*tree == NULL) return;
-
-    (*tree)->key = key;
-    (*tree)->value = value;
-    (*tree)->left = NULL;
-    (*tree)->right = NULL;
+    // Tree is empty so create first node with a new pool
+    *tree = bst_pool_alloc(NULL, key, value);
   }
   else if ((*tree)->key == key)
   {
@@ -90,13 +84,19 @@ void bst_insert(bst_node_t **tree, char key, int value)
   }
   else if (key < (*tree)->key)
   {
-    // Going left
-    bst_insert(&(*tree)->left, key, value);
+    // Going left, a new leaf comes from the pool of this node
+    if ((*tree)->left == NULL)
+      (*tree)->left = bst_pool_alloc(*tree, key, value);
+    else
+      bst_insert(&(*tree)->left, key, value);
   }
   else
   {
     // Going right
-    bst_insert(&(*tree)->right, key, value);
+    if ((*tree)->right == NULL)
+      (*tree)->right = bst_pool_alloc(*tree, key, value);
+    else
+      bst_insert(&(*tree)->right, key, value);
   }
 }
 
@@ -131,7 +131,7 @@ void bst_replace_by_rightmost(bst_node_t *target, bst_node_t **tree)
     target->value = tmp->value;
     *tree = tmp->left;
 
-    free(tmp);
+    bst_pool_free(tmp);
   }
 }
 
@@ -164,21 +164,21 @@ void bst_delete(bst_node_t **tree, char key)
     if ((*tree)->left == NULL && (*tree)->right == NULL)
     {
       // its a leaf
-      free(*tree);
+      bst_pool_remove(*tree, NULL);
       *tree = NULL;
     }
     else if ((*tree)->left != NULL && (*tree)->right == NULL)
     {
       // it have only left side
       bst_node_t *tmp = (*tree)->left;
-      free(*tree);
+      bst_pool_remove(*tree, tmp);
       *tree = tmp;
     }
     else if ((*tree)->left == NULL && (*tree)->right != NULL)
     {
       // it have only right side
       bst_node_t *tmp = (*tree)->right;
-      free(*tree);
+      bst_pool_remove(*tree, tmp);
       *tree = tmp;
     }
     else
@@ -196,17 +196,16 @@ void bst_delete(bst_node_t **tree, char key)
  * inicializácii. Funkcia korektne uvoľní všetky alokované zdroje rušených
  * uzlov.
  *
- * Funkciu implementujte rekurzívne bez použitia vlastných pomocných funkcií.
+ * tree may also point to a subtree, which is disposed alone. All nodes come
+ * from the pool of the tree; disposing the whole tree frees the pool at once
+ * and a subtree gives its nodes back to it (see bst_pool_dispose).
  */
 void bst_dispose(bst_node_t **tree)
 {
   if (tree == NULL) return;
   if (*tree == NULL) return;
 
-  bst_dispose(&(*tree)->left);
-  bst_dispose(&(*tree)->right);
-
-  free(*tree);
+  bst_pool_dispose(*tree);
   *tree = NULL;
 }
 
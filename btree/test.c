@@ -11,6 +11,11 @@ const int additional_data_count = 6;
 const char additional_keys[] = {'S', 'R', 'Q', 'P', 'X', 'Y', 'Z'};
 const int additional_values[] = {10, 10, 10, 10, 10, 10};
 
+const int sorted_data_count = 15;
+const char sorted_keys[] = {'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H',
+                            'I', 'J', 'K', 'L', 'M', 'N', 'O'};
+const int sorted_values[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+
 const int traversal_data_count = 5;
 const char traversal_keys[] = {'D', 'B', 'A', 'C', 'E'};
 const int traversal_values[] = {1, 2, 3, 4, 5};
@@ -150,6 +155,44 @@ bst_delete(&test_tree, 'H');
 bst_print_tree(test_tree);
 ENDTEST
 
+TEST(test_tree_insert_sorted, "Insert keys in ascending order (A-O)")
+bst_init(&test_tree);
+bst_insert_many(&test_tree, sorted_keys, sorted_values, sorted_data_count);
+bst_print_tree(test_tree);
+bst_delete(&test_tree, 'H');
+bst_delete(&test_tree, 'A');
+bst_delete(&test_tree, 'B');
+bst_print_tree(test_tree);
+ENDTEST
+
+TEST(test_tree_traverse_deep, "Traverse a tree deeper than 30 levels (z-0)")
+bst_init(&test_tree);
+for (char key = 'z'; key >= '0'; key--) {
+  bst_insert(&test_tree, key, key - '0');
+}
+bst_preorder(test_tree);
+printf("\n");
+bst_inorder(test_tree);
+printf("\n");
+bst_postorder(test_tree);
+printf("\n");
+ENDTEST
+
+TEST(test_tree_traverse_deep_right,
+     "Traverse a deep left branch with a right child at each node (z-1)")
+bst_init(&test_tree);
+for (char key = 'y'; key >= '0'; key -= 2) {
+  bst_insert(&test_tree, key, key - '0');
+  bst_insert(&test_tree, key + 1, key + 1 - '0');
+}
+bst_preorder(test_tree);
+printf("\n");
+bst_inorder(test_tree);
+printf("\n");
+bst_postorder(test_tree);
+printf("\n");
+ENDTEST
+
 TEST(test_tree_dispose_filled, "Dispose the whole tree")
 bst_init(&test_tree);
 bst_insert_many(&test_tree, base_keys, base_values, base_data_count);
@@ -158,6 +201,15 @@ bst_dispose(&test_tree);
 bst_print_tree(test_tree);
 ENDTEST
 
+TEST(test_tree_dispose_subtree, "Dispose the left subtree and insert (A)")
+bst_init(&test_tree);
+bst_insert_many(&test_tree, base_keys, base_values, base_data_count);
+bst_dispose(&test_tree->left);
+bst_print_tree(test_tree);
+bst_insert(&test_tree, 'A', 1);
+bst_print_tree(test_tree);
+ENDTEST
+
 TEST(test_tree_preorder, "Traverse the tree using preorder")
 bst_init(&test_tree);
 bst_insert_many(&test_tree, traversal_keys, traversal_values,
@@ -204,7 +256,11 @@ int main(int argc, char *argv[]) {
   test_tree_delete_both_subtrees_parent();
   test_tree_delete_missing();
   test_tree_delete_root();
+  test_tree_insert_sorted();
+  test_tree_traverse_deep();
+  test_tree_traverse_deep_right();
   test_tree_dispose_filled();
+  test_tree_dispose_subtree();
   test_tree_preorder();
   test_tree_inorder();
   test_tree_postorder();
@@ -0,0 +1,107 @@
+/*
+ * Test of the typed tree (typed_bst.h) with 64-bit integer keys and with
+ * string keys. The output is compared with typed.out.
+ */
+
+#include "typed_bst.h"
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+
+BSTDEC(uint64_t, double, id)
+BSTDEF(uint64_t, double, id, BST_CMP_NUMBER)
+
+BSTDEC(const char *, int, str)
+BSTDEF(const char *, int, str, BST_CMP_STRING)
+
+const int id_count = 9;
+const uint64_t id_keys[] = {5000000000u, 300, 9007199254740993u, 256, 1000,
+                            18446744073709551615u, 0, 42, 7000000000u};
+
+const int str_count = 8;
+const char *str_keys[] = {"mango", "apple", "pear", "banana",
+                          "cherry", "zucchini", "fig", "apricot"};
+
+void print_id(uint64_t key, double value, void *data) {
+  printf("[%" PRIu64 ",%g]", key, value);
+}
+
+void print_str(const char *key, int value, void *data) {
+  printf("[%s,%d]", key, value);
+}
+
+void count_visit(const char *key, int value, void *data) {
+  (*(int *)data)++;
+}
+
+void test_id_tree() {
+  printf("[test_id_tree] 64-bit keys\n");
+  bst_id_node_t *tree;
+  bst_id_init(&tree);
+  for (int i = 0; i < id_count; i++) {
+    bst_id_insert(&tree, id_keys[i], i * 1.5);
+  }
+  bst_id_insert(&tree, 256, -1);
+
+  bst_id_inorder(tree, print_id, NULL);
+  printf("\n");
+
+  double value;
+  bool found = bst_id_search(tree, 9007199254740993u, &value);
+  printf("search 9007199254740993: %s %g\n", found ? "true" : "false", value);
+  found = bst_id_search(tree, 9007199254740992u, &value);
+  printf("search 9007199254740992: %s\n", found ? "true" : "false");
+
+  // A leaf, a node with one subtree, a node with both and the root
+  bst_id_delete(&tree, 0);
+  bst_id_delete(&tree, 1000);
+  bst_id_delete(&tree, 300);
+  bst_id_delete(&tree, 5000000000u);
+  bst_id_delete(&tree, 12345);
+  bst_id_preorder(tree, print_id, NULL);
+  printf("\n");
+  bst_id_postorder(tree, print_id, NULL);
+  printf("\n");
+
+  bst_id_dispose(&tree);
+  printf("disposed: %s\n\n", tree == NULL ? "true" : "false");
+}
+
+void test_str_tree() {
+  printf("[test_str_tree] String keys\n");
+  bst_str_node_t *tree;
+  bst_str_init(&tree);
+  for (int i = 0; i < str_count; i++) {
+    bst_str_insert(&tree, str_keys[i], i);
+  }
+
+  // Equal strings at another address find the same node
+  char key[] = "cherry";
+  bst_str_insert(&tree, key, 100);
+  bst_str_inorder(tree, print_str, NULL);
+  printf("\n");
+
+  bst_str_delete(&tree, "mango");
+  bst_str_delete(&tree, "apple");
+  bst_str_delete(&tree, "kiwi");
+  bst_str_preorder(tree, print_str, NULL);
+  printf("\n");
+
+  int count = 0;
+  bst_str_inorder(tree, count_visit, &count);
+  int value;
+  printf("items: %d, search fig: %s\n", count,
+         bst_str_search(tree, "fig", &value) ? "true" : "false");
+
+  bst_str_dispose(&tree);
+  printf("disposed: %s\n\n", tree == NULL ? "true" : "false");
+}
+
+int main(int argc, char *argv[]) {
+  printf("Typed Binary Search Tree - testing script\n");
+  printf("-----------------------------------------\n");
+  printf("\n");
+
+  test_id_tree();
+  test_str_tree();
+}
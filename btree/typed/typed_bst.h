@@ -0,0 +1,198 @@
+/*
+ * Hlavičkový súbor pre typový binárny vyhľadávací strom.
+ *
+ * bst_node_t of btree.h is fixed to a char key and an int value. The macros
+ * below generate the same tree for any key and value types, in the manner of
+ * STACKDEC in iter/stack.h. The comparator is a macro or an inline function
+ * CMP(a, b) returning a negative number, zero or a positive number; it is
+ * expanded into every generated function, so comparing integers costs no
+ * call through a pointer.
+ *
+ * BSTDEC declares the types and functions, BSTDEF generates their bodies
+ * and belongs to exactly one .c file per instantiation. Search, insert,
+ * delete and dispose are loops, the traversals recurse. Keys and values are
+ * copied into nodes by assignment: a tree of strings stores the pointers and
+ * the caller keeps the strings alive.
+ */
+
+#ifndef IAL_BTREE_TYPED_BST_H
+#define IAL_BTREE_TYPED_BST_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Porovnanie čísel bez pretečenia rozdielu
+#define BST_CMP_NUMBER(a, b) (((a) > (b)) - ((a) < (b)))
+
+// Porovnanie reťazcov ukončených nulou
+#define BST_CMP_STRING(a, b) strcmp((a), (b))
+
+/*
+ * Makro generujúce deklarácie pre strom s kľúčom typu K, hodnotou typu V
+ * a názvovým infixom TNAME. Pre TNAME="id", K="uint64_t", V="double":
+ *   Dátový typ bst_id_node_t
+ *   Funkcie void bst_id_init(bst_id_node_t **tree)
+ *           void bst_id_insert(bst_id_node_t **tree, uint64_t key, double value)
+ *           bool bst_id_search(bst_id_node_t *tree, uint64_t key, double *value)
+ *           void bst_id_delete(bst_id_node_t **tree, uint64_t key)
+ *           void bst_id_dispose(bst_id_node_t **tree)
+ *           void bst_id_preorder(bst_id_node_t *tree, visit, void *data)
+ *           a rovnako bst_id_inorder a bst_id_postorder,
+ *   kde visit je void (*)(uint64_t key, double value, void *data).
+ */
+#define BSTDEC(K, V, TNAME)                                                    \
+  typedef struct bst_##TNAME##_node {                                          \
+    K key;                                                                     \
+    V value;                                                                   \
+    struct bst_##TNAME##_node *left;                                           \
+    struct bst_##TNAME##_node *right;                                          \
+  } bst_##TNAME##_node_t;                                                      \
+                                                                               \
+  typedef void (*bst_##TNAME##_visit_t)(K key, V value, void *data);           \
+                                                                               \
+  void bst_##TNAME##_init(bst_##TNAME##_node_t **tree);                        \
+  void bst_##TNAME##_insert(bst_##TNAME##_node_t **tree, K key, V value);      \
+  bool bst_##TNAME##_search(bst_##TNAME##_node_t *tree, K key, V *value);      \
+  void bst_##TNAME##_delete(bst_##TNAME##_node_t **tree, K key);               \
+  void bst_##TNAME##_dispose(bst_##TNAME##_node_t **tree);                     \
+  void bst_##TNAME##_preorder(bst_##TNAME##_node_t *tree,                      \
+                              bst_##TNAME##_visit_t visit, void *data);        \
+  void bst_##TNAME##_inorder(bst_##TNAME##_node_t *tree,                       \
+                             bst_##TNAME##_visit_t visit, void *data);         \
+  void bst_##TNAME##_postorder(bst_##TNAME##_node_t *tree,                     \
+                               bst_##TNAME##_visit_t visit, void *data);
+
+/*
+ * Makro generujúce implementáciu funkcií deklarovaných v BSTDEC s
+ * porovnaním CMP. Semantics follow the char tree: insert replaces the
+ * value of an existing key, delete of a node with both subtrees moves the
+ * rightmost node of its left subtree into its place and a missing key is
+ * ignored.
+ */
+#define BSTDEF(K, V, TNAME, CMP)                                               \
+  void bst_##TNAME##_init(bst_##TNAME##_node_t **tree) {                       \
+    if (tree != NULL) {                                                        \
+      *tree = NULL;                                                            \
+    }                                                                          \
+  }                                                                            \
+                                                                               \
+  bool bst_##TNAME##_search(bst_##TNAME##_node_t *tree, K key, V *value) {     \
+    while (tree != NULL) {                                                     \
+      int cmp = CMP(key, tree->key);                                           \
+      if (cmp == 0) {                                                          \
+        *value = tree->value;                                                  \
+        return true;                                                           \
+      }                                                                        \
+      tree = cmp < 0 ? tree->left : tree->right;                               \
+    }                                                                          \
+    return false;                                                              \
+  }                                                                            \
+                                                                               \
+  void bst_##TNAME##_insert(bst_##TNAME##_node_t **tree, K key, V value) {     \
+    if (tree == NULL) {                                                        \
+      return;                                                                  \
+    }                                                                          \
+    while (*tree != NULL) {                                                    \
+      int cmp = CMP(key, (*tree)->key);                                        \
+      if (cmp == 0) {                                                          \
+        (*tree)->value = value;                                                \
+        return;                                                                \
+      }                                                                        \
+      tree = cmp < 0 ? &(*tree)->left : &(*tree)->right;                       \
+    }                                                                          \
+                                                                               \
+    bst_##TNAME##_node_t *node =                                               \
+        (bst_##TNAME##_node_t *)malloc(sizeof(bst_##TNAME##_node_t));          \
+    if (node == NULL) {                                                        \
+      return;                                                                  \
+    }                                                                          \
+    node->key = key;                                                           \
+    node->value = value;                                                       \
+    node->left = NULL;                                                         \
+    node->right = NULL;                                                        \
+    *tree = node;                                                              \
+  }                                                                            \
+                                                                               \
+  void bst_##TNAME##_delete(bst_##TNAME##_node_t **tree, K key) {              \
+    if (tree == NULL) {                                                        \
+      return;                                                                  \
+    }                                                                          \
+    while (*tree != NULL) {                                                    \
+      int cmp = CMP(key, (*tree)->key);                                        \
+      if (cmp == 0) {                                                          \
+        break;                                                                 \
+      }                                                                        \
+      tree = cmp < 0 ? &(*tree)->left : &(*tree)->right;                       \
+    }                                                                          \
+    if (*tree == NULL) {                                                       \
+      return;                                                                  \
+    }                                                                          \
+                                                                               \
+    bst_##TNAME##_node_t *target = *tree;                                      \
+    if (target->left != NULL && target->right != NULL) {                       \
+      /* Replaced by the rightmost node of the left subtree */                 \
+      tree = &target->left;                                                    \
+      while ((*tree)->right != NULL) {                                         \
+        tree = &(*tree)->right;                                                \
+      }                                                                        \
+      bst_##TNAME##_node_t *rightmost = *tree;                                 \
+      target->key = rightmost->key;                                            \
+      target->value = rightmost->value;                                        \
+      *tree = rightmost->left;                                                 \
+      free(rightmost);                                                         \
+    } else {                                                                   \
+      *tree = target->left != NULL ? target->left : target->right;             \
+      free(target);                                                            \
+    }                                                                          \
+  }                                                                            \
+                                                                               \
+  void bst_##TNAME##_dispose(bst_##TNAME##_node_t **tree) {                    \
+    if (tree == NULL) {                                                        \
+      return;                                                                  \
+    }                                                                          \
+    /* Rotating left children up flattens the tree without a stack */          \
+    bst_##TNAME##_node_t *node = *tree;                                        \
+    while (node != NULL) {                                                     \
+      if (node->left != NULL) {                                                \
+        bst_##TNAME##_node_t *left = node->left;                               \
+        node->left = left->right;                                              \
+        left->right = node;                                                    \
+        node = left;                                                           \
+      } else {                                                                 \
+        bst_##TNAME##_node_t *right = node->right;                             \
+        free(node);                                                            \
+        node = right;                                                          \
+      }                                                                        \
+    }                                                                          \
+    *tree = NULL;                                                              \
+  }                                                                            \
+                                                                               \
+  void bst_##TNAME##_preorder(bst_##TNAME##_node_t *tree,                      \
+                              bst_##TNAME##_visit_t visit, void *data) {       \
+    if (tree != NULL) {                                                        \
+      visit(tree->key, tree->value, data);                                     \
+      bst_##TNAME##_preorder(tree->left, visit, data);                         \
+      bst_##TNAME##_preorder(tree->right, visit, data);                        \
+    }                                                                          \
+  }                                                                            \
+                                                                               \
+  void bst_##TNAME##_inorder(bst_##TNAME##_node_t *tree,                       \
+                             bst_##TNAME##_visit_t visit, void *data) {        \
+    if (tree != NULL) {                                                        \
+      bst_##TNAME##_inorder(tree->left, visit, data);                          \
+      visit(tree->key, tree->value, data);                                     \
+      bst_##TNAME##_inorder(tree->right, visit, data);                         \
+    }                                                                          \
+  }                                                                            \
+                                                                               \
+  void bst_##TNAME##_postorder(bst_##TNAME##_node_t *tree,                     \
+                               bst_##TNAME##_visit_t visit, void *data) {      \
+    if (tree != NULL) {                                                        \
+      bst_##TNAME##_postorder(tree->left, visit, data);                        \
+      bst_##TNAME##_postorder(tree->right, visit, data);                       \
+      visit(tree->key, tree->value, data);                                     \
+    }                                                                          \
+  }
+
+#endif
@@ -0,0 +1,298 @@
+/*
+ * Benchmarks of the table.
+ *
+ * reset: a scratch table with a large bucket array is filled with a few keys
+ * and emptied again, once with ht_delete_all and once with ht_clear. Times
+ * are per fill and reset cycle and include the fill.
+ *
+ * hash: ht_hash called per key against ht_hash_many on the same keys.
+ *
+ * lookup: ht_get on a table of BENCH_BUCKETS keys against ht_frozen_get on
+ * its frozen copy, for present and missing keys.
+ *
+ * pool: BENCH_TABLES tables holding the same keys, with keys stored in the
+ * item records, in a pool per table and in one interning pool they share.
+ * Memory is that of items and keys (ht_stats), lookups go to the first table.
+ *
+ * wal: inserts without a log, with group commits and with a commit (fsync)
+ * per insert. The last one only runs BENCH_WAL_SYNCED inserts, each of them
+ * waits for the disk.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "hashtable.h"
+#include "ht_frozen.h"
+#include "ht_hash.h"
+#include "ht_pool.h"
+#include "ht_wal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define BENCH_BUCKETS 65536
+#define BENCH_OPS 4000000
+#define BENCH_TABLES 4
+#define BENCH_WAL_SYNCED 2000
+
+static double seconds(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static double reset_cycle(char *keys[], int live, void (*reset)(ht_table_t *)) {
+  ht_table_t table;
+  ht_init(&table);
+
+  int rounds = BENCH_OPS / live;
+  double start = seconds();
+  for (int round = 0; round < rounds; round++) {
+    for (int i = 0; i < live; i++) {
+      ht_insert(&table, keys[i], i);
+    }
+    reset(&table);
+  }
+  double elapsed = seconds() - start;
+
+  ht_delete_all(&table);
+  return elapsed / rounds * 1e9;
+}
+
+static void bench_reset(void) {
+  int sizes[] = {16, 256, 4096, BENCH_BUCKETS};
+  char **keys = (char **)malloc(BENCH_BUCKETS * sizeof(char *));
+  for (int i = 0; i < BENCH_BUCKETS; i++) {
+    keys[i] = (char *)malloc(16);
+    sprintf(keys[i], "key%i", i);
+  }
+
+  HT_SIZE = BENCH_BUCKETS;
+  printf("[reset] %i buckets, ns per fill and reset\n", BENCH_BUCKETS);
+  printf("%8s %14s %14s\n", "live", "ht_delete_all", "ht_clear");
+  for (int i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+    double delete_all = reset_cycle(keys, sizes[i], ht_delete_all);
+    double clear = reset_cycle(keys, sizes[i], ht_clear);
+    printf("%8i %14.0f %14.0f\n", sizes[i], delete_all, clear);
+  }
+  HT_SIZE = HT_DEFAULT_SIZE;
+
+  for (int i = 0; i < BENCH_BUCKETS; i++) {
+    free(keys[i]);
+  }
+  free(keys);
+}
+
+static void bench_hash(void) {
+  int lengths[] = {4, 8, 16, 32};
+  char *buffer = (char *)malloc(BENCH_BUCKETS * 33);
+  const char **keys = (const char **)malloc(BENCH_BUCKETS * sizeof(char *));
+  size_t *sizes = (size_t *)malloc(BENCH_BUCKETS * sizeof(size_t));
+  uint64_t *hashes = (uint64_t *)malloc(BENCH_BUCKETS * sizeof(uint64_t));
+
+  printf("[hash] %s, ns per key\n", ht_hash_kernel());
+  printf("%8s %14s %14s\n", "length", "ht_hash", "ht_hash_many");
+  for (int l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+    for (int i = 0; i < BENCH_BUCKETS; i++) {
+      keys[i] = buffer + i * 33;
+      sizes[i] = lengths[l];
+      sprintf(buffer + i * 33, "%0*i", lengths[l], i);
+    }
+
+    int rounds = BENCH_OPS / BENCH_BUCKETS;
+    double start = seconds();
+    for (int round = 0; round < rounds; round++) {
+      for (int i = 0; i < BENCH_BUCKETS; i++) {
+        hashes[i] = ht_hash(keys[i], sizes[i]);
+      }
+    }
+    double single = seconds() - start;
+
+    start = seconds();
+    for (int round = 0; round < rounds; round++) {
+      ht_hash_many(keys, sizes, BENCH_BUCKETS, hashes);
+    }
+    double many = seconds() - start;
+
+    printf("%8i %14.2f %14.2f\n", lengths[l], single / BENCH_OPS * 1e9,
+           many / BENCH_OPS * 1e9);
+  }
+
+  free(buffer);
+  free(keys);
+  free(sizes);
+  free(hashes);
+}
+
+// Keeps the results of timed lookups alive
+static volatile int bench_sink;
+
+static double lookup_rounds(ht_table_t *table, ht_frozen_t *frozen,
+                            char *keys[]) {
+  int rounds = BENCH_OPS / BENCH_BUCKETS;
+  int found = 0;
+  double start = seconds();
+  for (int round = 0; round < rounds; round++) {
+    for (int i = 0; i < BENCH_BUCKETS; i++) {
+      if (table != NULL) {
+        found += ht_get(table, keys[i]) != NULL;
+      } else {
+        found += ht_frozen_get(frozen, keys[i]) != NULL;
+      }
+    }
+  }
+  double elapsed = seconds() - start;
+  bench_sink += found;
+  return elapsed / (rounds * BENCH_BUCKETS) * 1e9;
+}
+
+static void bench_lookup(void) {
+  char **keys = (char **)malloc(BENCH_BUCKETS * sizeof(char *));
+  char **missing = (char **)malloc(BENCH_BUCKETS * sizeof(char *));
+  ht_table_t table;
+  ht_init(&table);
+  for (int i = 0; i < BENCH_BUCKETS; i++) {
+    keys[i] = (char *)malloc(16);
+    missing[i] = (char *)malloc(16);
+    sprintf(keys[i], "key%i", i);
+    sprintf(missing[i], "missing%i", i);
+    ht_insert(&table, keys[i], i);
+  }
+
+  double start = seconds();
+  ht_frozen_t *frozen = ht_freeze(&table);
+  double freeze = seconds() - start;
+
+  printf("[lookup] %i keys, ns per lookup, ht_freeze took %.1f ms\n",
+         BENCH_BUCKETS, freeze * 1e3);
+  double present = lookup_rounds(&table, NULL, keys);
+  double absent = lookup_rounds(&table, NULL, missing);
+  ht_enable_bloom(&table, 0.01f, 0);
+
+  printf("%8s %14s %14s %14s\n", "keys", "ht_get", "with filter", "ht_frozen_get");
+  printf("%8s %14.2f %14.2f %14.2f\n", "present", present,
+         lookup_rounds(&table, NULL, keys), lookup_rounds(NULL, frozen, keys));
+  printf("%8s %14.2f %14.2f %14.2f\n", "missing", absent,
+         lookup_rounds(&table, NULL, missing), lookup_rounds(NULL, frozen, missing));
+
+  ht_frozen_free(frozen);
+  ht_delete_all(&table);
+  for (int i = 0; i < BENCH_BUCKETS; i++) {
+    free(keys[i]);
+    free(missing[i]);
+  }
+  free(keys);
+  free(missing);
+}
+
+// Fills BENCH_TABLES tables with the keys, stored in the items, in a pool
+// of each table (own) or in the shared pool, and times lookups
+static void pool_layout(char *name, char *keys[], ht_pool_t *shared,
+                          int own) {
+  ht_table_t tables[BENCH_TABLES];
+  size_t bytes = 0;
+  for (int t = 0; t < BENCH_TABLES; t++) {
+    ht_init(&tables[t]);
+    if (own || shared != NULL) {
+      ht_enable_pool(&tables[t], shared);
+    }
+    for (int i = 0; i < BENCH_BUCKETS; i++) {
+      ht_insert(&tables[t], keys[i], i);
+    }
+
+    ht_stats_t stats;
+    ht_stats(&tables[t], &stats);
+    bytes += stats.item_bytes;
+    if (shared == NULL || t == 0) {
+      bytes += stats.pool_bytes;
+    }
+  }
+
+  printf("%10s %14.2f %14.2f\n", name, bytes / 1048576.0,
+         lookup_rounds(&tables[0], NULL, keys));
+  for (int t = 0; t < BENCH_TABLES; t++) {
+    ht_delete_all(&tables[t]);
+  }
+}
+
+static void bench_pool(void) {
+  char **keys = (char **)malloc(BENCH_BUCKETS * sizeof(char *));
+  for (int i = 0; i < BENCH_BUCKETS; i++) {
+    keys[i] = (char *)malloc(32);
+    sprintf(keys[i], "session:%08i:user", i);
+  }
+
+  printf("[pool] %i tables of the same %i keys\n", BENCH_TABLES, BENCH_BUCKETS);
+  printf("%10s %14s %14s\n", "keys", "MiB", "ns per ht_get");
+  pool_layout("in items", keys, NULL, 0);
+  pool_layout("own pool", keys, NULL, 1);
+  ht_pool_t *pool = ht_pool_new(true);
+  pool_layout("shared", keys, pool, 0);
+  ht_pool_free(pool);
+
+  for (int i = 0; i < BENCH_BUCKETS; i++) {
+    free(keys[i]);
+  }
+  free(keys);
+}
+
+// Inserts count keys, logged to bench.wal unless log is 0, and prints the
+// time per insert
+static void wal_inserts(char *name, char *keys[], int count, int log,
+                        double interval) {
+  ht_table_t table;
+  ht_init(&table);
+  remove("bench.wal");
+  ht_wal_t *wal = log ? ht_wal_open("bench.wal", 0, interval) : NULL;
+
+  double start = seconds();
+  for (int i = 0; i < count; i++) {
+    if (wal != NULL) {
+      ht_wal_insert(wal, &table, keys[i], i);
+    } else {
+      ht_insert(&table, keys[i], i);
+    }
+  }
+  unsigned long commits = 0;
+  if (wal != NULL) {
+    ht_wal_commit(wal);
+    commits = wal->commits;
+    ht_wal_close(wal);
+  }
+  double elapsed = seconds() - start;
+
+  printf("%10s %8i %14.2f %10lu\n", name, count, elapsed / count * 1e9,
+         commits);
+  ht_delete_all(&table);
+  remove("bench.wal");
+}
+
+static void bench_wal(void) {
+  char **keys = (char **)malloc(BENCH_BUCKETS * sizeof(char *));
+  for (int i = 0; i < BENCH_BUCKETS; i++) {
+    keys[i] = (char *)malloc(32);
+    sprintf(keys[i], "session:%08i:user", i);
+  }
+
+  HT_SIZE = BENCH_BUCKETS;
+  printf("[wal] inserts into a table of %i buckets\n", BENCH_BUCKETS);
+  printf("%10s %8s %14s %10s\n", "log", "inserts", "ns per insert", "commits");
+  wal_inserts("none", keys, BENCH_BUCKETS, 0, 0);
+  wal_inserts("group", keys, BENCH_BUCKETS, 1, 0.01);
+  wal_inserts("per op", keys, BENCH_WAL_SYNCED, 1, 0);
+  HT_SIZE = HT_DEFAULT_SIZE;
+
+  for (int i = 0; i < BENCH_BUCKETS; i++) {
+    free(keys[i]);
+  }
+  free(keys);
+}
+
+int main(int argc, char *argv[]) {
+  bench_reset();
+  bench_hash();
+  bench_lookup();
+  bench_pool();
+  bench_wal();
+  return 0;
+}
@@ -9,125 +9,1015 @@
  */
 
 #include "hashtable.h"
+#include "ht_bloom.h"
+#include "ht_hash.h"
+#include "ht_pool.h"
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 
-int HT_SIZE = MAX_HT_SIZE;
+int HT_SIZE = HT_DEFAULT_SIZE;
 
 /*
  * Rozptyľovacia funkcia ktorá pridelí zadanému kľúču index z intervalu
  * <0,HT_SIZE-1>. Ideálna rozptyľovacia funkcia by mala rozprestrieť kľúče
  * rovnomerne po všetkých indexoch. Zamyslite sa nad kvalitou zvolenej funkcie.
+ *
+ * The 64-bit hash itself comes from ht_hash.c (variant chosen at build time).
+ * Tables map it to their own current size, see ht_chain.
+ */
+int get_hash(char *key) {
+  return ht_hash_index(ht_hash(key, strlen(key)), HT_SIZE);
+}
+
+/*
+ * Slab of the item allocator, records start at data.
+ */
+typedef struct ht_slab {
+  struct ht_slab *prev;
+  struct ht_slab *next;
+  max_align_t data[];
+} ht_slab_t;
+
+/*
+ * Item record: the item followed by its key, so one allocation covers both.
+ */
+typedef struct ht_node {
+  ht_item_t item;
+  char key[];
+} ht_node_t;
+
+static size_t ht_record_size(size_t length)
+{
+  size_t size = sizeof(ht_node_t) + length + 1;
+  return (size + HT_SLAB_ALIGN - 1) / HT_SLAB_ALIGN * HT_SLAB_ALIGN;
+}
+
+/*
+ * Links of an item on the list of the cache mode, stored at the end of its
+ * record (ht_arena_t extra) only while the table is a cache.
+ */
+typedef struct ht_cache_links {
+  ht_item_t *newer; // novšie použitý prvok
+  ht_item_t *older; // staršie použitý prvok
+} ht_cache_links_t;
+
+#define HT_CACHE_LINKS_SIZE                                                   \
+  ((sizeof(ht_cache_links_t) + HT_SLAB_ALIGN - 1) / HT_SLAB_ALIGN * HT_SLAB_ALIGN)
+
+static void ht_arena_init(ht_arena_t *arena)
+{
+  arena->slabs = NULL;
+  arena->free_space = NULL;
+  arena->free_end = NULL;
+  arena->extra = 0;
+  for (int i = 0; i < HT_SLAB_CLASSES; i++)
+  {
+    arena->free_lists[i] = NULL;
+  }
+}
+
+/*
+ * Frees all slabs at once, without visiting the records in them.
+ */
+static void ht_arena_release(ht_arena_t *arena)
+{
+  ht_slab_t *slab = arena->slabs;
+  while (slab != NULL)
+  {
+    ht_slab_t *next = slab->next;
+    free(slab);
+    slab = next;
+  }
+
+  ht_arena_init(arena);
+}
+
+static ht_slab_t *ht_slab_new(ht_arena_t *arena, size_t size)
+{
+  ht_slab_t *slab = (ht_slab_t*)malloc(sizeof(ht_slab_t) + size);
+  if (slab == NULL) return NULL;
+
+  slab->prev = NULL;
+  slab->next = arena->slabs;
+  if (arena->slabs != NULL)
+    arena->slabs->prev = slab;
+  arena->slabs = slab;
+
+  return slab;
+}
+
+// Size of the record of an item without the extra bytes of the arena
+static size_t ht_item_base_size(ht_table_t *table, size_t length)
+{
+  if (table->pool != NULL)
+    return (sizeof(ht_node_t) + HT_SLAB_ALIGN - 1) / HT_SLAB_ALIGN * HT_SLAB_ALIGN;
+  return ht_record_size(length);
+}
+
+/*
+ * Size of the record of an item with a key of length; with a key pool the
+ * record holds only the item, in cache mode the links follow.
+ */
+static size_t ht_item_size(ht_table_t *table, size_t length)
+{
+  return ht_item_base_size(table, length) + table->arena.extra;
+}
+
+static inline ht_cache_links_t *ht_cache_links(ht_table_t *table, ht_item_t *item)
+{
+  return (ht_cache_links_t*)((char*)item + ht_item_base_size(table, item->length));
+}
+
+/*
+ * Allocates an item record of size bytes. Records are reused from the free
+ * list of their size class, then cut from the newest slab.
+ */
+static ht_item_t *ht_item_alloc(ht_arena_t *arena, size_t size)
+{
+  size_t size_class = size / HT_SLAB_ALIGN - 1;
+  ht_node_t *node;
+
+  if (size_class >= HT_SLAB_CLASSES)
+  {
+    // Too big for the size classes, gets a slab of its own
+    ht_slab_t *slab = ht_slab_new(arena, size);
+    if (slab == NULL) return NULL;
+    node = (ht_node_t*)slab->data;
+  }
+  else if (arena->free_lists[size_class] != NULL)
+  {
+    node = (ht_node_t*)arena->free_lists[size_class];
+    arena->free_lists[size_class] = node->item.next;
+  }
+  else
+  {
+    if ((size_t)(arena->free_end - arena->free_space) < size)
+    {
+      ht_slab_t *slab = ht_slab_new(arena, HT_SLAB_SIZE);
+      if (slab == NULL) return NULL;
+      arena->free_space = (char*)slab->data;
+      arena->free_end = arena->free_space + HT_SLAB_SIZE;
+    }
+
+    node = (ht_node_t*)arena->free_space;
+    arena->free_space += size;
+  }
+
+  return &node->item;
+}
+
+/*
+ * Empties the arena but keeps the slab it currently cuts records from, so a
+ * table that is cleared and refilled does not go back to malloc. Costs one
+ * free per other slab, the records are not visited.
+ */
+static void ht_arena_reset(ht_arena_t *arena)
+{
+  ht_slab_t *keep = NULL;
+  if (arena->free_end != NULL)
+    keep = (ht_slab_t*)(arena->free_end - HT_SLAB_SIZE - offsetof(ht_slab_t, data));
+
+  ht_slab_t *slab = arena->slabs;
+  while (slab != NULL)
+  {
+    ht_slab_t *next = slab->next;
+    if (slab != keep)
+      free(slab);
+    slab = next;
+  }
+
+  ht_arena_init(arena);
+  if (keep != NULL)
+  {
+    keep->prev = NULL;
+    keep->next = NULL;
+    arena->slabs = keep;
+    arena->free_space = (char*)keep->data;
+    arena->free_end = arena->free_space + HT_SLAB_SIZE;
+  }
+}
+
+/*
+ * Returns an item record of size bytes to the free list of its size class.
+ * Large records give their slab back right away.
+ */
+static void ht_item_free(ht_arena_t *arena, ht_item_t *item, size_t size)
+{
+  size_t size_class = size / HT_SLAB_ALIGN - 1;
+
+  if (size_class >= HT_SLAB_CLASSES)
+  {
+    ht_slab_t *slab = (ht_slab_t*)((char*)item - offsetof(ht_slab_t, data));
+    if (slab->prev != NULL)
+      slab->prev->next = slab->next;
+    else
+      arena->slabs = slab->next;
+    if (slab->next != NULL)
+      slab->next->prev = slab->prev;
+
+    free(slab);
+  }
+  else
+  {
+    item->next = arena->free_lists[size_class];
+    arena->free_lists[size_class] = item;
+  }
+}
+
+/*
+ * Allocates an item for the key, copied into its record or added to the key
+ * pool of the table. Returns NULL if memory runs out.
+ */
+static ht_item_t *ht_item_new(ht_table_t *table, const char *key, size_t length,
+                              uint64_t hash)
+{
+  ht_item_t *item = ht_item_alloc(&table->arena, ht_item_size(table, length));
+  if (item == NULL) return NULL;
+
+  if (table->pool == NULL)
+  {
+    ht_node_t *node = (ht_node_t*)item;
+    memcpy(node->key, key, length + 1);
+    item->key = node->key;
+  }
+  else
+  {
+    item->key = (char*)ht_pool_add(table->pool, key, length, hash);
+    if (item->key == NULL)
+    {
+      ht_item_free(&table->arena, item, ht_item_size(table, length));
+      return NULL;
+    }
+  }
+
+  item->length = (unsigned)length;
+  return item;
+}
+
+/*
+ * Returns the chain a key with the given hash belongs to. While the table is
+ * being resized that is the old chain unless it was already moved.
+ *
+ * Expects the bucket array to be allocated.
+ */
+static ht_item_t **ht_chain(ht_table_t *table, uint64_t hash)
+{
+  if (table->old_buckets != NULL)
+  {
+    int old_index = ht_hash_index(hash, table->old_size);
+    if (old_index >= table->rehash_index)
+      return &table->old_buckets[old_index];
+  }
+
+  return &table->buckets[ht_hash_index(hash, table->size)];
+}
+
+/*
+ * Cheap checks on the cached hash and length come first, the key bytes are
+ * compared only for a probable match.
+ */
+static inline bool ht_item_matches(ht_item_t *item, const char *key,
+                                   size_t length, uint64_t hash)
+{
+  return item->hash == hash && item->length == length &&
+         memcmp(item->key, key, length) == 0;
+}
+
+/*
+ * Links item in front of the recency list of the cache.
+ */
+static void ht_cache_push(ht_table_t *table, ht_item_t *item)
+{
+  ht_cache_t *cache = table->cache;
+  ht_cache_links_t *links = ht_cache_links(table, item);
+  links->newer = NULL;
+  links->older = cache->newest;
+  if (cache->newest != NULL)
+    ht_cache_links(table, cache->newest)->newer = item;
+  else
+    cache->oldest = item;
+  cache->newest = item;
+}
+
+static void ht_cache_unlink(ht_table_t *table, ht_item_t *item)
+{
+  ht_cache_t *cache = table->cache;
+  ht_cache_links_t *links = ht_cache_links(table, item);
+  if (links->newer != NULL)
+    ht_cache_links(table, links->newer)->older = links->older;
+  else
+    cache->newest = links->older;
+  if (links->older != NULL)
+    ht_cache_links(table, links->older)->newer = links->newer;
+  else
+    cache->oldest = links->newer;
+}
+
+/*
+ * Records a hit of item. LRU moves it to the front of the list, CLOCK only
+ * sets its bit (and writes nothing once it is set).
+ */
+static inline void ht_cache_touch(ht_table_t *table, ht_item_t *item)
+{
+  if (table->cache->policy == HT_CACHE_CLOCK)
+  {
+    if (!item->referenced)
+      item->referenced = 1;
+  }
+  else if (table->cache->newest != item)
+  {
+    ht_cache_unlink(table, item);
+    ht_cache_push(table, item);
+  }
+}
+
+// Memory of an item counted against max_bytes, its key and links included
+static size_t ht_cache_record_size(size_t length)
+{
+  return ht_record_size(length) + HT_CACHE_LINKS_SIZE;
+}
+
+/*
+ * Returns the item with the given key or NULL. The head of its chain is
+ * stored to chain, if not NULL.
+ */
+static ht_item_t *ht_find(ht_table_t *table, const char *key, size_t length,
+                          uint64_t hash, ht_item_t ***chain)
+{
+  ht_item_t **head = ht_chain(table, hash);
+  if (chain != NULL)
+    *chain = head;
+
+  HT_COUNT(table, lookups, 1);
+
+  if (table->bloom != NULL && !ht_bloom_contains(table->bloom, hash))
+  {
+    HT_COUNT(table, filtered, 1);
+    HT_COUNT(table, misses, 1);
+    return NULL;
+  }
+
+  ht_item_t *item = *head;
+  while (item != NULL)
+  {
+    HT_COUNT(table, comparisons, 1);
+    if (ht_item_matches(item, key, length, hash))
+    {
+      HT_COUNT(table, hits, 1);
+      if (table->cache != NULL)
+        ht_cache_touch(table, item);
+      return item;
+    }
+
+    item = item->next;
+  }
+
+  HT_COUNT(table, misses, 1);
+  return NULL;
+}
+
+/*
+ * Passes every item of the table to visit, including the old buckets not yet
+ * moved by a resize. visit must not unlink the item.
+ */
+static void ht_walk(ht_table_t *table, ht_scan_callback_t visit, void *data)
+{
+  for (int i = 0; table->buckets != NULL && i < table->size; i++)
+  {
+    for (ht_item_t *item = table->buckets[i]; item != NULL; item = item->next)
+      visit(item, data);
+  }
+  for (int i = table->rehash_index; table->old_buckets != NULL && i < table->old_size; i++)
+  {
+    for (ht_item_t *item = table->old_buckets[i]; item != NULL; item = item->next)
+      visit(item, data);
+  }
+}
+
+static void ht_bloom_visit(ht_item_t *item, void *data)
+{
+  ht_bloom_add((ht_bloom_t*)data, item->hash);
+}
+
+/*
+ * Adds the hashes of all items of the table to bloom.
+ */
+static void ht_bloom_fill(ht_table_t *table, ht_bloom_t *bloom)
+{
+  ht_walk(table, ht_bloom_visit, bloom);
+}
+
+// Keys a new Bloom filter is sized for: room to double, at least min_size
+static int ht_bloom_capacity(ht_table_t *table)
+{
+  return 2 * table->count > table->min_size ? 2 * table->count : table->min_size;
+}
+
+/*
+ * Builds the Bloom filter again from the items of the table, with the same
+ * settings and sized by ht_bloom_capacity. Returns false, keeping the old
+ * filter, if memory runs out.
+ */
+static bool ht_bloom_rebuild(ht_table_t *table)
+{
+  ht_bloom_t *bloom = ht_bloom_new(ht_bloom_capacity(table), table->bloom->fpr,
+                                   table->bloom->max_bytes);
+  if (bloom == NULL) return false;
+
+  ht_bloom_fill(table, bloom);
+  ht_bloom_free(table->bloom);
+  table->bloom = bloom;
+  return true;
+}
+
+/*
+ * Removes the item *link points to from its chain and frees it.
+ */
+static void ht_remove(ht_table_t *table, ht_item_t **link)
+{
+  ht_item_t *item = *link;
+  *link = item->next;
+  if (table->cache != NULL)
+  {
+    ht_cache_unlink(table, item);
+    table->cache->bytes -= ht_cache_record_size(item->length);
+  }
+  if (table->pool != NULL)
+    ht_pool_release(table->pool, item->key);
+  ht_item_free(&table->arena, item, ht_item_size(table, item->length));
+  table->count--;
+
+  // Deleted keys keep their bits, rebuild once they are a large share
+  if (table->bloom != NULL &&
+      ++table->bloom->deleted > HT_BLOOM_REBUILD * table->count)
+    ht_bloom_rebuild(table);
+}
+
+/*
+ * Evicts items from the oldest end of the cache list until the table fits
+ * its limits. keep, the item just inserted, is never evicted, even when it
+ * alone is over max_bytes.
+ */
+static void ht_cache_evict(ht_table_t *table, ht_item_t *keep)
+{
+  ht_cache_t *cache = table->cache;
+
+  while ((cache->max_items > 0 && table->count > cache->max_items) ||
+         (cache->max_bytes > 0 && cache->bytes > cache->max_bytes))
+  {
+    ht_item_t *victim = cache->oldest;
+    if (victim == keep)
+      victim = ht_cache_links(table, victim)->newer;
+    if (victim == NULL) return;
+
+    // Second chance of CLOCK, the hand moves past the item
+    if (victim->referenced)
+    {
+      victim->referenced = 0;
+      ht_cache_unlink(table, victim);
+      ht_cache_push(table, victim);
+      continue;
+    }
+
+    ht_item_t **link = ht_chain(table, victim->hash);
+    while (*link != victim)
+      link = &(*link)->next;
+
+    ht_remove(table, link);
+    cache->evictions++;
+  }
+}
+
+/*
+ * Records that bucket index of the current array is about to become
+ * non-empty, see ht_clear.
+ */
+static inline void ht_mark_occupied(ht_table_t *table, int index)
+{
+  if (table->occupied_count < table->size)
+    table->occupied[table->occupied_count++] = index;
+}
+
+/*
+ * Moves up to HT_REHASH_STEP non-empty old buckets to the new bucket array
+ * and frees the old array once it is drained.
+ */
+static void ht_rehash_step(ht_table_t *table)
+{
+  if (table->old_buckets == NULL) return;
+
+  // Bound the number of empty buckets skipped so the step stays cheap
+  int moved = 0;
+  int visited = 0;
+  while (table->rehash_index < table->old_size &&
+         moved < HT_REHASH_STEP && visited < HT_REHASH_STEP * 10)
+  {
+    ht_item_t *item = table->old_buckets[table->rehash_index];
+    while (item != NULL)
+    {
+      ht_item_t *next = item->next;
+      int index = ht_hash_index(item->hash, table->size);
+      ht_item_t **chain = &table->buckets[index];
+
+      if (*chain == NULL)
+        ht_mark_occupied(table, index);
+      item->next = *chain;
+      *chain = item;
+
+      item = next;
+    }
+
+    if (table->old_buckets[table->rehash_index] != NULL)
+      moved++;
+    visited++;
+
+    table->old_buckets[table->rehash_index] = NULL;
+    table->rehash_index++;
+  }
+
+  if (table->rehash_index == table->old_size)
+  {
+    free(table->old_buckets);
+    table->old_buckets = NULL;
+    table->old_size = 0;
+    table->rehash_index = 0;
+  }
+}
+
+/*
+ * Starts moving the table to a bucket array of new_size. A resize that is
+ * already running is finished first. If the allocation fails the table keeps
+ * its current size.
+ */
+static void ht_resize(ht_table_t *table, int new_size)
+{
+  while (table->old_buckets != NULL)
+  {
+    ht_rehash_step(table);
+  }
+
+  ht_item_t **buckets = (ht_item_t**)calloc(new_size, sizeof(ht_item_t*));
+  int *occupied = (int*)malloc(new_size * sizeof(int));
+  if (buckets == NULL || occupied == NULL)
+  {
+    free(buckets);
+    free(occupied);
+    return;
+  }
+
+  free(table->occupied);
+  table->old_buckets = table->buckets;
+  table->old_size = table->size;
+  table->rehash_index = 0;
+  table->buckets = buckets;
+  table->size = new_size;
+  table->occupied = occupied;
+  table->occupied_count = 0;
+}
+
+/*
+ * Inicializácia tabuľky — zavolá sa pred prvým použitím tabuľky.
+ *
+ * Pole zoznamov synoným sa alokuje až pri prvom vložení.
+ */
+void ht_init(ht_table_t *table) 
+{
+  if (table == NULL) return;
+
+  table->buckets = NULL;
+  table->size = HT_SIZE;
+  table->occupied = NULL;
+  table->occupied_count = 0;
+  table->old_buckets = NULL;
+  table->old_size = 0;
+  table->rehash_index = 0;
+  table->min_size = HT_SIZE;
+  table->count = 0;
+  table->max_load = HT_MAX_LOAD;
+  table->min_load = HT_MIN_LOAD;
+  ht_arena_init(&table->arena);
+  table->bloom = NULL;
+  table->cache = NULL;
+  table->pool = NULL;
+  table->pool_owned = false;
+#ifdef HT_STATS
+  memset(&table->counters, 0, sizeof(table->counters));
+#endif
+}
+
+/*
+ * Vyhľadanie prvku v tabuľke.
+ *
+ * V prípade úspechu vráti ukazovateľ na nájdený prvok; v opačnom prípade vráti
+ * hodnotu NULL.
+ */
+ht_item_t *ht_search(ht_table_t *table, char *key) 
+{
+  if (table == NULL || table->buckets == NULL) return NULL;
+
+  size_t length = strlen(key);
+  return ht_find(table, key, length, ht_hash(key, length), NULL);
+}
+
+/*
+ * Allocates the bucket array of a table that has none yet.
+ */
+static bool ht_alloc_buckets(ht_table_t *table)
+{
+  if (table->buckets != NULL) return true;
+
+  table->buckets = (ht_item_t**)calloc(table->size, sizeof(ht_item_t*));
+  table->occupied = (int*)malloc(table->size * sizeof(int));
+  if (table->buckets == NULL || table->occupied == NULL)
+  {
+    free(table->buckets);
+    free(table->occupied);
+    table->buckets = NULL;
+    table->occupied = NULL;
+    return false;
+  }
+
+  table->occupied_count = 0;
+  return true;
+}
+
+/*
+ * Inserts the key with an already computed length and hash, or finds it.
+ *
+ * An existing item gets value only if overwrite is set. Returns the value
+ * slot of the item, or NULL when a new item could not be allocated.
+ */
+static float *ht_put_hashed(ht_table_t *table, char *key, size_t length,
+                            uint64_t hash, float value, bool overwrite,
+                            bool *inserted)
+{
+  ht_rehash_step(table);
+
+  ht_item_t **chain;
+  ht_item_t *item = ht_find(table, key, length, hash, &chain);
+  if (item != NULL)
+  {
+    if (overwrite)
+      item->value = value;
+    return &item->value;
+  }
+
+  item = ht_item_new(table, key, length, hash);
+  if (item == NULL) return NULL;
+
+  item->value = value;
+  item->hash = hash;
+  item->next = *chain;
+
+  int index = ht_hash_index(hash, table->size);
+  if (*chain == NULL && chain == &table->buckets[index])
+    ht_mark_occupied(table, index);
+
+  *chain = item;
+  table->count++;
+  if (inserted != NULL)
+    *inserted = true;
+
+  if (table->bloom != NULL)
+  {
+    bool rebuilt = table->count > table->bloom->capacity && ht_bloom_rebuild(table);
+    if (!rebuilt)
+      ht_bloom_add(table->bloom, hash);
+  }
+
+  if (table->cache != NULL)
+  {
+    item->referenced = 0;
+    ht_cache_push(table, item);
+    table->cache->bytes += ht_cache_record_size(length);
+    ht_cache_evict(table, item);
+  }
+
+  if (table->old_buckets == NULL &&
+      table->count > table->max_load * table->size)
+  {
+    ht_resize(table, table->size * 2);
+  }
+
+  return &item->value;
+}
+
+/*
+ * Looks the key up and inserts it when missing, hashing it only once.
+ */
+static float *ht_put(ht_table_t *table, char *key, float value,
+                     bool overwrite, bool *inserted)
+{
+  if (inserted != NULL)
+    *inserted = false;
+  if (table == NULL || !ht_alloc_buckets(table)) return NULL;
+
+  size_t length = strlen(key);
+  return ht_put_hashed(table, key, length, ht_hash(key, length), value,
+                       overwrite, inserted);
+}
+
+/*
+ * Vloženie nového prvku do tabuľky.
+ *
+ * Pokiaľ prvok s daným kľúčom už v tabuľke existuje, nahraďte jeho hodnotu.
+ *
+ * Pri vkladaní prvku do zoznamu synonym zvoľte najefektívnejšiu možnosť a
+ * vložte prvok na začiatok zoznamu.
+ *
+ * Keď počet položiek prekročí max_load násobok veľkosti, tabuľka sa začne
+ * zväčšovať na dvojnásobok.
+ *
+ * In cache mode an insert over the limits evicts the least recently used
+ * items (never the one inserted).
+ */
+void ht_insert(ht_table_t *table, char *key, float value) 
+{
+  ht_put(table, key, value, true, NULL);
+}
+
+/*
+ * Vloženie alebo prepísanie prvku jedným prechodom tabuľkou.
+ *
+ * Returns a pointer to the value of the item, which stays valid until the
+ * item is deleted, or NULL if the item could not be allocated.
  */
-int get_hash(char *key) {
-  int result = 1;
-  int length = strlen(key);
-  for (int i = 0; i < length; i++) {
-    result += key[i];
-  }
-  return (result % HT_SIZE);
+float *ht_upsert(ht_table_t *table, char *key, float value)
+{
+  return ht_put(table, key, value, true, NULL);
 }
 
 /*
- * Inicializácia tabuľky — zavolá sa pred prvým použitím tabuľky.
+ * Získanie hodnoty prvku, ktorý sa v prípade potreby vloží.
+ *
+ * A missing key is inserted with value, an existing item keeps its value.
+ * Returns a pointer to the value so the caller can update it in place, e.g.
+ * (*ht_get_or_insert(table, word, 0, NULL))++. When inserted is not NULL it
+ * tells whether the item was created.
  */
-void ht_init(ht_table_t *table) 
+float *ht_get_or_insert(ht_table_t *table, char *key, float value,
+                        bool *inserted)
+{
+  return ht_put(table, key, value, false, inserted);
+}
+
+/*
+ * Získanie hodnoty z tabuľky.
+ *
+ * V prípade úspechu vráti funkcia ukazovateľ na hodnotu prvku, v opačnom
+ * prípade hodnotu NULL.
+ *
+ * Pri implementácii využite funkciu ht_search.
+ */
+float *ht_get(ht_table_t *table, char *key) {
+  ht_item_t *item = ht_search(table, key);
+  if (item != NULL) return &item->value;
+  return NULL;
+}
+
+/*
+ * Grows the table so that count items fit under max_load. The new bucket
+ * array is filled right away, a bulk load should not pay for the incremental
+ * rehash on every insert.
+ */
+static void ht_reserve(ht_table_t *table, int count)
 {
-  for (int i = 0; i < HT_SIZE; i++)
+  int size = table->size;
+  while (count > table->max_load * size)
+  {
+    size *= 2;
+  }
+  if (size == table->size) return;
+
+  if (table->buckets == NULL)
   {
-    (*table)[i] = NULL;
+    table->size = size;
+    return;
+  }
+
+  ht_resize(table, size);
+  while (table->old_buckets != NULL)
+  {
+    ht_rehash_step(table);
   }
 }
 
 /*
- * Vyhľadanie prvku v tabuľke.
+ * Hromadné vloženie prvkov do tabuľky.
  *
- * V prípade úspechu vráti ukazovateľ na nájdený prvok; v opačnom prípade vráti
- * hodnotu NULL.
+ * The table is sized for all items up front. Keys are then hashed a batch at
+ * a time with ht_hash_many and the chain heads of the whole batch are
+ * prefetched before the first of them is inserted.
  */
-ht_item_t *ht_search(ht_table_t *table, char *key) 
+void ht_insert_many(ht_table_t *table, const ht_item_t items[], int count)
 {
-  int hash = get_hash(key);
-  ht_item_t *item = (*table)[hash];
+  if (table == NULL) return;
 
-  if (item != NULL)
+  ht_reserve(table, table->count + count);
+  if (!ht_alloc_buckets(table)) return;
+
+  const char *keys[HT_BATCH_SIZE];
+  size_t lengths[HT_BATCH_SIZE];
+  uint64_t hashes[HT_BATCH_SIZE];
+
+  for (int start = 0; start < count; start += HT_BATCH_SIZE)
   {
-    if (strcmp(item->key, key) == 0)
+    int batch = count - start < HT_BATCH_SIZE ? count - start : HT_BATCH_SIZE;
+
+    for (int i = 0; i < batch; i++)
     {
-      return item;
+      keys[i] = items[start + i].key;
+      lengths[i] = strlen(keys[i]);
     }
-    else
+    ht_hash_many(keys, lengths, batch, hashes);
+
+    for (int i = 0; i < batch; i++)
     {
-      while (item->next != NULL)
-      {
-        if (strcmp(item->next->key, key) == 0)
-        {
-          return item->next;
-        }
+      __builtin_prefetch(ht_chain(table, hashes[i]), 1);
+    }
 
-        item = item->next;
-      }
+    for (int i = 0; i < batch; i++)
+    {
+      ht_put_hashed(table, items[start + i].key, lengths[i], hashes[i],
+                    items[start + i].value, true, NULL);
     }
   }
-
-  return NULL;
 }
 
 /*
- * Vloženie nového prvku do tabuľky.
- *
- * Pokiaľ prvok s daným kľúčom už v tabuľke existuje, nahraďte jeho hodnotu.
+ * Hromadné získanie hodnôt z tabuľky.
  *
- * Pri implementácii využite funkciu ht_search. Pri vkladaní prvku do zoznamu
- * synonym zvoľte najefektívnejšiu možnosť a vložte prvok na začiatok zoznamu.
+ * values[i] is set to what ht_get(table, keys[i]) would return. Keys are
+ * processed in batches: all keys of a batch are hashed (ht_hash_many) and their
+ * chain heads (and filter blocks) prefetched first, then the lookups advance
+ * one chain step at a time in turns, prefetching each next item, so the cache
+ * misses of the whole batch overlap instead of being paid one after another.
  */
-void ht_insert(ht_table_t *table, char *key, float value) 
+void ht_get_many(ht_table_t *table, char *keys[], int count, float *values[])
 {
-  ht_item_t *item = ht_search(table, key);
-  if (item != NULL)
+  if (table == NULL || table->buckets == NULL)
   {
-    item->value = value;
+    for (int i = 0; i < count; i++)
+    {
+      values[i] = NULL;
+    }
+    return;
   }
-  else
+
+  size_t lengths[HT_BATCH_SIZE];
+  uint64_t hashes[HT_BATCH_SIZE];
+  ht_item_t **chains[HT_BATCH_SIZE];
+  ht_item_t *items[HT_BATCH_SIZE];
+
+  for (int start = 0; start < count; start += HT_BATCH_SIZE)
   {
-    int hash = get_hash(key);
-    item = (*table)[hash];
+    int batch = count - start < HT_BATCH_SIZE ? count - start : HT_BATCH_SIZE;
+
+    for (int i = 0; i < batch; i++)
+    {
+      lengths[i] = strlen(keys[start + i]);
+    }
+    ht_hash_many((const char **)&keys[start], lengths, batch, hashes);
 
-    ht_item_t *tmp = (ht_item_t*)malloc(sizeof(ht_item_t));
-    if (tmp == NULL) return;
+    for (int i = 0; i < batch; i++)
+    {
+      chains[i] = ht_chain(table, hashes[i]);
+      __builtin_prefetch(chains[i]);
+      if (table->bloom != NULL)
+        __builtin_prefetch(ht_bloom_block(table->bloom, hashes[i]));
+    }
 
-    tmp->key = (char*)malloc((strlen(key) + 1) * sizeof(char));
-    if (tmp->key == NULL)
+    for (int i = 0; i < batch; i++)
     {
-      free(tmp);
-      return;
+      HT_COUNT(table, lookups, 1);
+      values[start + i] = NULL;
+      if (table->bloom != NULL && !ht_bloom_contains(table->bloom, hashes[i]))
+      {
+        HT_COUNT(table, filtered, 1);
+        items[i] = NULL;
+        continue;
+      }
+
+      items[i] = *chains[i];
+      if (items[i] != NULL)
+        __builtin_prefetch(items[i]);
     }
 
-    strcpy(tmp->key, key);
-    tmp->value = value;
+    // Advance every unfinished lookup by one item per round
+    int active = batch;
+    while (active > 0)
+    {
+      active = 0;
+      for (int i = 0; i < batch; i++)
+      {
+        ht_item_t *item = items[i];
+        if (item == NULL)
+          continue;
+
+        HT_COUNT(table, comparisons, 1);
+        if (ht_item_matches(item, keys[start + i], lengths[i], hashes[i]))
+        {
+          if (table->cache != NULL)
+            ht_cache_touch(table, item);
+          values[start + i] = &item->value;
+          items[i] = NULL;
+          continue;
+        }
+
+        items[i] = item->next;
+        if (items[i] != NULL)
+        {
+          __builtin_prefetch(items[i]);
+          active++;
+        }
+      }
+    }
 
-    if (item != NULL)
+#ifdef HT_STATS
+    for (int i = 0; i < batch; i++)
     {
-      tmp->next = item;
+      if (values[start + i] != NULL)
+        table->counters.hits++;
+      else
+        table->counters.misses++;
     }
-    else tmp->next = NULL;
+#endif
+  }
+}
 
-    (*table)[hash] = tmp;
+/*
+ * Counts the items of chain whose hash position lies in <start,end) and
+ * passes them to callback unless it is NULL.
+ */
+static int ht_scan_chain(ht_item_t *item, uint64_t start, uint64_t end,
+                         ht_scan_callback_t callback, void *data)
+{
+  int count = 0;
+  for (; item != NULL; item = item->next)
+  {
+    uint64_t position = item->hash >> 32;
+    if (position >= start && position < end)
+    {
+      if (callback != NULL)
+        callback(item, data);
+      count++;
+    }
   }
+  return count;
 }
 
 /*
- * Získanie hodnoty z tabuľky.
+ * Postupný prechod všetkými prvkami tabuľky.
  *
- * V prípade úspechu vráti funkcia ukazovateľ na hodnotu prvku, v opačnom
- * prípade hodnotu NULL.
- *
- * Pri implementácii využite funkciu ht_search.
+ * Start with cursor 0 and call again with the returned cursor until it is 0.
+ * The cursor is a hash position (see ht_hash_position); each call walks whole
+ * buckets upwards from it and passes their items to callback, at most budget
+ * items unless the first bucket alone has more. Because buckets cover
+ * increasing hash ranges for any size, an item present during the whole scan
+ * is visited exactly once even if the table is modified or resized between
+ * calls. The callback must not modify the table.
  */
-float *ht_get(ht_table_t *table, char *key) {
-  ht_item_t *item = ht_search(table, key);
-  if (item != NULL) return &item->value;
-  return NULL;
+uint64_t ht_scan(ht_table_t *table, uint64_t cursor,
+                 ht_scan_callback_t callback, void *data, int budget)
+{
+  if (table == NULL || table->buckets == NULL) return 0;
+
+  int visited = 0;
+  int buckets = 0;
+
+  while (cursor < HT_HASH_POSITIONS)
+  {
+    // The range ends at the first bucket boundary of either array
+    int index = ht_hash_index(cursor << 32, table->size);
+    uint64_t end = ht_hash_position(index + 1, table->size);
+    ht_item_t *old_chain = NULL;
+
+    if (table->old_buckets != NULL)
+    {
+      int old_index = ht_hash_index(cursor << 32, table->old_size);
+      uint64_t old_end = ht_hash_position(old_index + 1, table->old_size);
+      if (old_end < end)
+        end = old_end;
+      if (old_index >= table->rehash_index)
+        old_chain = table->old_buckets[old_index];
+    }
+
+    int count = ht_scan_chain(table->buckets[index], cursor, end, NULL, NULL) +
+                ht_scan_chain(old_chain, cursor, end, NULL, NULL);
+    if (visited > 0 && visited + count > budget)
+      break;
+
+    ht_scan_chain(table->buckets[index], cursor, end, callback, data);
+    ht_scan_chain(old_chain, cursor, end, callback, data);
+    visited += count;
+    cursor = end;
+
+    if (visited >= budget || ++buckets >= budget * HT_SCAN_BUCKETS)
+      break;
+  }
+
+  return cursor < HT_HASH_POSITIONS ? cursor : 0;
 }
 
 /*
@@ -137,69 +1027,422 @@ float *ht_get(ht_table_t *table, char *key) {
  * Pokiaľ prvok neexistuje, nerobte nič.
  *
  * Pri implementácii NEVYUŽÍVAJTE funkciu ht_search.
+ *
+ * Keď počet položiek klesne pod min_load násobok veľkosti, tabuľka sa začne
+ * zmenšovať na polovicu (najviac na min_size).
  */
 void ht_delete(ht_table_t *table, char *key) 
 {
-  int hash = get_hash(key);
-  ht_item_t *item = (*table)[hash];
-  if (item == NULL) return;
-  else
+  if (table == NULL || table->buckets == NULL) return;
+
+  ht_rehash_step(table);
+
+  size_t length = strlen(key);
+  uint64_t hash = ht_hash(key, length);
+
+  HT_COUNT(table, lookups, 1);
+
+  bool absent = table->bloom != NULL && !ht_bloom_contains(table->bloom, hash);
+  ht_item_t **link = ht_chain(table, hash);
+  while (!absent && *link != NULL && !ht_item_matches(*link, key, length, hash))
   {
-    if (strcmp(item->key, key) == 0)
-    {
-      (*table)[hash] = item->next;
-      free(item->key);
-      free(item);
-    }
-    else
-    {
-      ht_item_t *prev = item;
-      item = item->next;
+    HT_COUNT(table, comparisons, 1);
+    link = &(*link)->next;
+  }
 
-      while (item != NULL)
-      {
-        if (strcmp(item->key, key) == 0)
-        {
-          prev->next = item->next;
-          free(item->key);
-          free(item);
-          break;
-        }
+  if (!absent && *link != NULL)
+  {
+    HT_COUNT(table, comparisons, 1);
+    HT_COUNT(table, hits, 1);
+    ht_remove(table, link);
+  }
+  else
+  {
+    if (absent)
+      HT_COUNT(table, filtered, 1);
+    HT_COUNT(table, misses, 1);
+  }
 
-        item = item->next;
-      }
-    }
+  if (table->old_buckets == NULL && table->size > table->min_size &&
+      table->count < table->min_load * table->size)
+  {
+    int new_size = table->size / 2;
+    if (new_size < table->min_size)
+      new_size = table->min_size;
+    ht_resize(table, new_size);
   }
 }
 
+static void ht_pool_visit(ht_item_t *item, void *data)
+{
+  ht_pool_release((ht_pool_t*)data, item->key);
+}
+
+/*
+ * Gives the keys of all items back to the key pool: an own pool is emptied
+ * at once, a shared one gets each reference released.
+ */
+static void ht_release_keys(ht_table_t *table)
+{
+  if (table->pool_owned)
+    ht_pool_clear(table->pool);
+  else if (table->pool != NULL)
+    ht_walk(table, ht_pool_visit, table->pool);
+}
+
 /*
  * Zmazanie všetkých prvkov z tabuľky.
  *
  * Funkcia korektne uvoľní všetky alokované zdroje a uvedie tabuľku do stavu po
  * inicializácii.
+ *
+ * Tabuľka sa vráti na veľkosť min_size, nastavené hranice zaťaženia ostávajú.
+ * Items are not visited, their slabs are freed as a whole, and so is an own
+ * key pool. The Bloom filter, the cache mode and the key pool are switched
+ * off like after ht_init.
  */
 void ht_delete_all(ht_table_t *table) 
 {
-  for (int i = 0; i < HT_SIZE; i++)
+  if (table == NULL) return;
+
+  if (table->pool_owned)
+    ht_pool_free(table->pool);
+  else
+    ht_release_keys(table);
+
+  free(table->buckets);
+  free(table->occupied);
+  free(table->old_buckets);
+  ht_arena_release(&table->arena);
+  ht_bloom_free(table->bloom);
+  free(table->cache);
+
+  table->buckets = NULL;
+  table->bloom = NULL;
+  table->cache = NULL;
+  table->pool = NULL;
+  table->pool_owned = false;
+  table->size = table->min_size;
+  table->occupied = NULL;
+  table->occupied_count = 0;
+  table->old_buckets = NULL;
+  table->old_size = 0;
+  table->rehash_index = 0;
+  table->count = 0;
+}
+
+/*
+ * Vyprázdnenie tabuľky bez uvoľnenia jej pamäte.
+ *
+ * Meant for tables that are emptied and refilled often. The bucket array
+ * keeps its size and only the buckets listed in occupied are reset, so the
+ * cost follows the number of used buckets instead of the table size; items
+ * are dropped with their slabs (ht_arena_reset). A resize in progress is
+ * abandoned, the old array is simply freed. An enabled Bloom filter and
+ * the cache mode stay enabled and are emptied; an own key pool is emptied at
+ * once, while a shared one has to be told about every key.
+ */
+void ht_clear(ht_table_t *table)
+{
+  if (table == NULL || table->buckets == NULL) return;
+
+  ht_release_keys(table);
+
+  free(table->old_buckets);
+  table->old_buckets = NULL;
+  table->old_size = 0;
+  table->rehash_index = 0;
+
+  if (table->occupied_count < table->size)
+  {
+    for (int i = 0; i < table->occupied_count; i++)
+    {
+      table->buckets[table->occupied[i]] = NULL;
+    }
+  }
+  else
+  {
+    memset(table->buckets, 0, table->size * sizeof(ht_item_t*));
+  }
+
+  table->occupied_count = 0;
+  table->count = 0;
+  ht_arena_reset(&table->arena);
+  ht_bloom_clear(table->bloom);
+  if (table->cache != NULL)
+  {
+    table->arena.extra = HT_CACHE_LINKS_SIZE;
+    table->cache->newest = NULL;
+    table->cache->oldest = NULL;
+    table->cache->bytes = 0;
+  }
+}
+
+/*
+ * Zapnutie Bloomovho filtra pred zoznamami synoným.
+ *
+ * fpr is the wanted false positive rate, max_bytes limits the size of the
+ * filter (0 for no limit) at the cost of a higher rate. The filter gets all
+ * current keys and follows later inserts and deletes: it is built again
+ * when the table outgrows it and after deletes reach HT_BLOOM_REBUILD of the
+ * items. An enabled filter is replaced. Returns false, leaving the table as
+ * it was, if memory runs out.
+ */
+bool ht_enable_bloom(ht_table_t *table, float fpr, size_t max_bytes)
+{
+  if (table == NULL) return false;
+
+  ht_bloom_t *bloom = ht_bloom_new(ht_bloom_capacity(table), fpr, max_bytes);
+  if (bloom == NULL) return false;
+
+  ht_bloom_fill(table, bloom);
+  ht_bloom_free(table->bloom);
+  table->bloom = bloom;
+  return true;
+}
+
+/*
+ * Vypnutie Bloomovho filtra.
+ */
+void ht_disable_bloom(ht_table_t *table)
+{
+  if (table == NULL) return;
+
+  ht_bloom_free(table->bloom);
+  table->bloom = NULL;
+}
+
+static void ht_cache_visit(ht_item_t *item, void *data)
+{
+  ht_table_t *table = (ht_table_t*)data;
+  ht_cache_push(table, item);
+  table->cache->bytes += ht_cache_record_size(item->length);
+}
+
+/*
+ * Moves every item to a record extra bytes longer than its base size, in a
+ * new arena, keeping the order of the chains. Nothing changes if memory runs
+ * out before all records are copied.
+ */
+static bool ht_arena_repack(ht_table_t *table, size_t extra)
+{
+  if (table->count == 0)
   {
-    if ((*table)[i] != NULL)
+    table->arena.extra = extra;
+    return true;
+  }
+
+  ht_item_t **moved = (ht_item_t**)malloc(table->count * sizeof(ht_item_t*));
+  if (moved == NULL) return false;
+
+  ht_arena_t arena;
+  ht_arena_init(&arena);
+  arena.extra = extra;
+
+  // Copies first, the chains still lead to the old records
+  int count = 0;
+  ht_item_t **lists[2] = {table->buckets, table->old_buckets};
+  int starts[2] = {0, table->rehash_index};
+  int ends[2] = {table->buckets != NULL ? table->size : 0, table->old_size};
+  for (int l = 0; l < 2; l++)
+  {
+    for (int i = starts[l]; lists[l] != NULL && i < ends[l]; i++)
     {
-      if ((*table)[i]->next != NULL)
+      for (ht_item_t *item = lists[l][i]; item != NULL; item = item->next)
       {
-        ht_item_t *current = (*table)[i]->next;
-        while (current != NULL)
+        size_t base = ht_item_base_size(table, item->length);
+        ht_item_t *copy = ht_item_alloc(&arena, base + extra);
+        if (copy == NULL)
         {
-          ht_item_t *next = current->next;
-          free(current->key);
-          free(current);
-
-          current = next;
+          ht_arena_release(&arena);
+          free(moved);
+          return false;
         }
+
+        memcpy(copy, item, base);
+        if (table->pool == NULL)
+          copy->key = ((ht_node_t*)copy)->key;
+        moved[count++] = copy;
       }
+    }
+  }
+
+  // A copy still points to the next old record, which is replaced next
+  count = 0;
+  for (int l = 0; l < 2; l++)
+  {
+    for (int i = starts[l]; lists[l] != NULL && i < ends[l]; i++)
+    {
+      for (ht_item_t **link = &lists[l][i]; *link != NULL; link = &(*link)->next)
+        *link = moved[count++];
+    }
+  }
+
+  free(moved);
+  ht_arena_release(&table->arena);
+  table->arena = arena;
+  return true;
+}
 
-      free((*table)[i]->key);
-      free((*table)[i]);
-      (*table)[i] = NULL;
+/*
+ * Zapnutie režimu vyrovnávacej pamäte.
+ *
+ * max_items limits the number of items and max_bytes the memory of their
+ * records (item, key and links, the bucket array is not counted); 0 means
+ * no limit. Items already in the table go to the list in bucket order and
+ * the table is cut down to the limits right away. They are first moved to
+ * records with room for the links, unless the table was a cache before, so
+ * pointers to them become invalid. Called again on a cache table it only
+ * changes the limits and the policy, the order of use is kept. Returns
+ * false if memory runs out.
+ */
+bool ht_enable_cache(ht_table_t *table, int max_items, size_t max_bytes,
+                     ht_cache_policy_t policy)
+{
+  if (table == NULL) return false;
+
+  ht_cache_t *cache = table->cache;
+  if (cache == NULL)
+  {
+    cache = (ht_cache_t*)malloc(sizeof(ht_cache_t));
+    if (cache == NULL) return false;
+
+    // Records of a table that was never a cache have no room for links
+    if (table->arena.extra == 0 &&
+        !ht_arena_repack(table, HT_CACHE_LINKS_SIZE))
+    {
+      free(cache);
+      return false;
     }
+
+    cache->newest = NULL;
+    cache->oldest = NULL;
+    cache->bytes = 0;
+    cache->evictions = 0;
+    table->cache = cache;
+    ht_walk(table, ht_cache_visit, table);
+  }
+
+  // Bits set under CLOCK mean nothing to LRU and would be stale later
+  for (ht_item_t *item = cache->newest; item != NULL;
+       item = ht_cache_links(table, item)->older)
+    item->referenced = 0;
+
+  cache->max_items = max_items > 0 ? max_items : 0;
+  cache->max_bytes = max_bytes;
+  cache->policy = policy;
+  ht_cache_evict(table, NULL);
+  return true;
+}
+
+/*
+ * Vypnutie režimu vyrovnávacej pamäte.
+ *
+ * The items stay in the table, only the limits and the list are dropped.
+ * Their records keep the room for the links until the table is emptied, so
+ * pointers to items stay valid.
+ */
+void ht_disable_cache(ht_table_t *table)
+{
+  if (table == NULL) return;
+
+  free(table->cache);
+  table->cache = NULL;
+}
+
+/*
+ * Uloženie kľúčov do zásobníka.
+ *
+ * Only for an empty table. With pool NULL the table gets a pool of its own,
+ * freed together with it by ht_delete_all. A shared pool (ht_pool_new with
+ * intern set) stores keys common to several tables once; it has to outlive
+ * them and is compacted with ht_pool_compact over all of them. Returns false
+ * if the table is not empty or memory runs out.
+ */
+bool ht_enable_pool(ht_table_t *table, ht_pool_t *pool)
+{
+  if (table == NULL || table->count > 0) return false;
+
+  bool owned = pool == NULL;
+  if (owned)
+  {
+    pool = ht_pool_new(false);
+    if (pool == NULL) return false;
+  }
+
+  if (table->pool_owned)
+    ht_pool_free(table->pool);
+  table->pool = pool;
+  table->pool_owned = owned;
+  return true;
+}
+
+static void ht_stats_chain(ht_stats_t *stats, ht_item_t *item)
+{
+  int length = 0;
+  for (; item != NULL; item = item->next)
+  {
+    length++;
+  }
+
+  stats->buckets++;
+  stats->items += length;
+  if (length == 0)
+    stats->empty_buckets++;
+  if (length > stats->max_chain)
+    stats->max_chain = length;
+  stats->chains[length < HT_STATS_CHAINS ? length : HT_STATS_CHAINS - 1]++;
+}
+
+// Adds the record size of an item whose key is stored in it
+static void ht_stats_visit(ht_item_t *item, void *data)
+{
+  *(size_t*)data += ht_record_size(item->length);
+}
+
+/*
+ * Štatistika tabuľky.
+ *
+ * Walks all chains, including the old buckets not yet moved by a resize that
+ * is in progress. Counters are copied only with -DHT_STATS, otherwise zero.
+ * The false positive rate of an enabled Bloom filter is estimated from its
+ * bits. Memory of the items counts their records (with the keys stored
+ * in them) and the key pool separately, the bucket array is not included.
+ */
+void ht_stats(ht_table_t *table, ht_stats_t *stats)
+{
+  memset(stats, 0, sizeof(*stats));
+  if (table == NULL) return;
+
+  for (int i = 0; i < table->size; i++)
+  {
+    ht_stats_chain(stats, table->buckets != NULL ? table->buckets[i] : NULL);
+  }
+  for (int i = table->rehash_index; table->old_buckets != NULL && i < table->old_size; i++)
+  {
+    ht_stats_chain(stats, table->old_buckets[i]);
+  }
+
+  stats->load_factor = (float)stats->items / table->size;
+  stats->filter_bytes = ht_bloom_bytes(table->bloom);
+  stats->filter_fpr = table->bloom != NULL ? (float)ht_bloom_fpr(table->bloom) : 0.0f;
+  if (table->cache != NULL)
+  {
+    stats->cache_bytes = table->cache->bytes;
+    stats->evictions = table->cache->evictions;
+  }
+  if (table->pool != NULL)
+  {
+    stats->item_bytes = stats->items * ht_item_size(table, 0);
+    stats->pool_bytes = table->pool->bytes;
+    stats->pool_garbage = table->pool->garbage;
+  }
+  else
+  {
+    ht_walk(table, ht_stats_visit, &stats->item_bytes);
+    stats->item_bytes += stats->items * table->arena.extra;
   }
+#ifdef HT_STATS
+  stats->counters = table->counters;
+#endif
 }
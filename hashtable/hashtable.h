@@ -1,42 +1,312 @@
 /*
  * Hlavičkový súbor pre tabuľku s rozptýlenými položkami.
- * Tento súbor neupravujte.
  */
 
 #ifndef IAL_HASHTABLE_H
 #define IAL_HASHTABLE_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 /*
- * Maximálna veľkosť poľa pre implementáciu tabuľky.
- * Funkcie pracujúce s tabuľkou uvažujú veľkosť HT_SIZE.
+ * Predvolená počiatočná veľkosť tabuľky.
  */
-#define MAX_HT_SIZE 101
+#define HT_DEFAULT_SIZE 101
 
 /*
- * Veľkosť tabuľky s ktorou pracujú implementované funkcie.
+ * Počiatočná veľkosť tabuliek inicializovaných funkciou ht_init.
  * Pre účely testovania je vhodné mať možnosť meniť veľkosť tabuľky.
- * Pre správne fungovanie musí byť veľkosť prvočíslom.
+ * Tabuľka sa pod túto veľkosť nikdy nezmenší.
  */
 extern int HT_SIZE;
 
+// Default load factor limits of a new table
+#define HT_MAX_LOAD 1.0f  // grow (double) when items / buckets exceeds this
+#define HT_MIN_LOAD 0.25f // shrink (halve) when items / buckets drops below
+
+// Number of keys hashed and prefetched together by ht_*_many
+#define HT_BATCH_SIZE 16
+
+// Buckets ht_scan may pass per unit of its budget, bounds calls over
+// long runs of empty buckets
+#define HT_SCAN_BUCKETS 10
+
+// Number of old buckets moved to the new array per insert or delete
+#define HT_REHASH_STEP 4
+
 // Prvok tabuľky
 typedef struct ht_item {
-  char *key;            // kľúč prvku
-  float value;          // hodnota prvku
-  struct ht_item *next; // ukazateľ na ďalšie synonymum
+  char *key;               // kľúč prvku
+  float value;             // hodnota prvku
+  unsigned length : 31;    // dĺžka kľúča
+  unsigned referenced : 1; // použitý od posledného prechodu (HT_CACHE_CLOCK)
+  struct ht_item *next;    // ukazateľ na ďalšie synonymum
+  uint64_t hash;           // rozptylová hodnota kľúča (ht_hash)
 } ht_item_t;
 
-// Tabuľka o reálnej veľkosti MAX_HT_SIZE
-typedef ht_item_t *ht_table_t[MAX_HT_SIZE];
+// Number of chain lengths in the ht_stats histogram, the last entry counts
+// all longer chains
+#define HT_STATS_CHAINS 8
+
+/*
+ * Počítadlá operácií, udržiavané len pri preklade s -DHT_STATS.
+ *
+ * comparisons counts the items a lookup compared with the searched key (the
+ * cached hash is compared first), so comparisons / lookups is the average
+ * probe length.
+ */
+typedef struct ht_counters {
+  unsigned long lookups;     // počet vyhľadaní (aj pri vkladaní a mazaní)
+  unsigned long hits;        // nájdené kľúče
+  unsigned long misses;      // nenájdené kľúče
+  unsigned long comparisons; // porovnania s kľúčmi prvkov
+  unsigned long filtered;    // neúspešné vyhľadania vybavené filtrom
+} ht_counters_t;
+
+#ifdef HT_STATS
+#define HT_COUNT(TABLE, COUNTER, N) ((TABLE)->counters.COUNTER += (N))
+#else
+#define HT_COUNT(TABLE, COUNTER, N) ((void)0)
+#endif
+
+// Štatistika tabuľky vrátená funkciou ht_stats
+typedef struct ht_stats {
+  int buckets;                  // počet zoznamov (skupín pri HT_SWISS)
+  int items;                    // počet položiek
+  int empty_buckets;            // počet prázdnych zoznamov
+  int max_chain;                // dĺžka najdlhšieho zoznamu
+  float load_factor;            // položky / veľkosť tabuľky
+  int chains[HT_STATS_CHAINS];  // počet zoznamov podľa dĺžky
+  ht_counters_t counters;       // počítadlá, bez -DHT_STATS nulové
+  size_t filter_bytes;          // veľkosť Bloomovho filtra, 0 ak nie je
+  float filter_fpr;             // odhad falošných zhôd filtra
+  size_t cache_bytes;           // veľkosť záznamov v režime cache, inak 0
+  unsigned long evictions;      // prvky vyhodené v režime cache
+  size_t item_bytes;            // veľkosť záznamov prvkov (bez zásobníka)
+  size_t pool_bytes;            // veľkosť záznamov zásobníka kľúčov
+  size_t pool_garbage;          // z toho uvoľnené záznamy
+} ht_stats_t;
+
+// Funkcia volaná pre každý prvok navštívený pomocou ht_scan
+typedef void (*ht_scan_callback_t)(ht_item_t *item, void *data);
+
+#ifdef HT_SWISS
+
+// Number of slots whose control bytes are compared at once
+#define HT_GROUP_SIZE 16
+
+// Maximum load factor of the open addressing table
+#define HT_SWISS_MAX_LOAD 0.875f
+
+/*
+ * Tabuľka s otvoreným adresovaním (-DHT_SWISS).
+ *
+ * Items are stored directly in the slots array. For every slot ctrl holds
+ * HT_CTRL_EMPTY, HT_CTRL_DELETED or the low 7 bits of the hash of its key,
+ * so a lookup compares a whole group of HT_GROUP_SIZE control bytes before it
+ * looks at any key. The number of slots is a power of two and a multiple of
+ * HT_GROUP_SIZE. Pointers returned by ht_search stay valid only until the
+ * next insert or delete.
+ */
+typedef struct ht_table {
+  signed char *ctrl;  // riadiace bajty slotov (NULL pred prvým vložením)
+  ht_item_t *slots;   // pole slotov
+  int size;           // počet slotov
+  int min_size;       // veľkosť pod ktorú sa tabuľka nezmenší
+  int count;          // počet položiek v tabuľke
+  int growth_left;    // počet vložení do prázdnych slotov pred zväčšením
+  float max_load;     // hranica zväčšenia tabuľky
+  float min_load;     // hranica zmenšenia tabuľky
+#ifdef HT_STATS
+  ht_counters_t counters; // počítadlá operácií
+#endif
+} ht_table_t;
+
+#define HT_CTRL_EMPTY ((signed char)-128)
+#define HT_CTRL_DELETED ((signed char)-2)
+
+#elif defined(HT_CUCKOO)
+
+// Slots of one bucket, their hashes and item pointers fill one cache line
+#define HT_CUCKOO_SLOTS 4
+
+// The second bucket of a key lies at most HT_CUCKOO_WINDOW - 1 buckets after
+// the first one, so ht_scan finds items moved to it nearby
+#define HT_CUCKOO_WINDOW 64
+
+// Items an insert may move before the item left over goes to the stash
+#define HT_CUCKOO_MAX_KICKS 128
+
+// Items kept outside of the buckets before the table has to grow
+#define HT_CUCKOO_STASH 4
+
+// Maximum load factor of the cuckoo table, inserts rarely fail below it
+#define HT_CUCKOO_MAX_LOAD 0.85f
+
+/*
+ * Skupina slotov tabuľky s kukučím rozptýlením.
+ *
+ * The full hash of every item is kept next to its pointer, so a lookup reads
+ * an item only when its hash matches.
+ */
+typedef struct ht_bucket {
+  _Alignas(64) uint64_t hashes[HT_CUCKOO_SLOTS]; // rozptylové hodnoty kľúčov
+  ht_item_t *items[HT_CUCKOO_SLOTS];             // prvky, NULL pre voľný slot
+} ht_bucket_t;
+
+/*
+ * Tabuľka s kukučím rozptýlením (-DHT_CUCKOO).
+ *
+ * Every key may live in one of two buckets of HT_CUCKOO_SLOTS slots, or in
+ * the small stash when an insert could not make room for it. A lookup reads
+ * at most the two buckets and, only if it is not empty, the stash. Items are
+ * allocated one by one and never move in memory, so pointers returned by
+ * ht_search stay valid until the item is deleted.
+ */
+typedef struct ht_table {
+  ht_bucket_t *buckets;              // pole skupín (NULL pred prvým vložením)
+  int size;                          // počet slotov (násobok HT_CUCKOO_SLOTS)
+  int min_size;                      // veľkosť pod ktorú sa tabuľka nezmenší
+  int count;                         // počet položiek v tabuľke
+  ht_item_t *stash[HT_CUCKOO_STASH]; // prvky mimo skupín
+  int stash_count;                   // počet prvkov v stash
+  uint32_t random;                   // stav generátora pre výber vyhodených
+  float max_load;                    // hranica zväčšenia tabuľky
+  float min_load;                    // hranica zmenšenia tabuľky
+#ifdef HT_STATS
+  ht_counters_t counters;            // počítadlá operácií
+#endif
+} ht_table_t;
+
+#else
+
+// Bytes per slab of the item allocator
+#define HT_SLAB_SIZE 8192
+
+// Deletes, as a share of the items left, after which the Bloom filter is
+// built again so deleted keys stop passing it
+#define HT_BLOOM_REBUILD 0.5f
+
+// Item records are rounded up to HT_SLAB_ALIGN bytes; records of up to
+// HT_SLAB_CLASSES * HT_SLAB_ALIGN bytes are carved from slabs, larger ones get
+// a slab of their own
+#define HT_SLAB_ALIGN 16
+#define HT_SLAB_CLASSES 16
+
+/*
+ * Alokátor položiek tabuľky.
+ *
+ * Every item is one record holding the ht_item_t followed by its key. Records
+ * are cut from the newest slab; freed records go to the free list of their
+ * size class and are reused by later inserts. Slabs are only returned to the
+ * system when the whole table is emptied. The cache mode adds links of
+ * extra bytes to the end of every record.
+ */
+typedef struct ht_arena {
+  struct ht_slab *slabs;                  // zoznam všetkých slabov
+  char *free_space;                       // voľné miesto v najnovšom slabe
+  char *free_end;                         // koniec najnovšieho slabu
+  ht_item_t *free_lists[HT_SLAB_CLASSES]; // uvoľnené záznamy podľa veľkosti
+  size_t extra;                           // bajty odkazov na konci záznamov
+} ht_arena_t;
+
+// Eviction policies of the cache mode
+typedef enum ht_cache_policy {
+  HT_CACHE_LRU,  // every hit moves the item to the front of the list
+  HT_CACHE_CLOCK // a hit only sets referenced, the list changes on eviction
+} ht_cache_policy_t;
+
+/*
+ * Režim vyrovnávacej pamäte.
+ *
+ * All items are on a doubly linked list, the most recently used first. An
+ * insert over max_items or max_bytes evicts from the oldest end. With
+ * HT_CACHE_CLOCK the list is in insertion order and the oldest end is the
+ * clock hand: a referenced item gets a second chance (its bit is cleared and
+ * it goes to the front) instead of being evicted.
+ *
+ * The links of the list are stored at the end of the item records, which
+ * only grow by them (16 bytes) when the cache mode is enabled; tables
+ * without it do not pay for them.
+ */
+typedef struct ht_cache {
+  ht_item_t *newest;        // naposledy použitý (vložený) prvok
+  ht_item_t *oldest;        // najdlhšie nepoužitý prvok
+  int max_items;            // najväčší počet prvkov, 0 bez obmedzenia
+  size_t max_bytes;         // najväčšia veľkosť záznamov, 0 bez obmedzenia
+  size_t bytes;             // veľkosť záznamov prvkov v tabuľke
+  ht_cache_policy_t policy; // stratégia vyhadzovania
+  unsigned long evictions;  // počet vyhodených prvkov
+} ht_cache_t;
+
+/*
+ * Tabuľka s meniacou sa veľkosťou.
+ *
+ * While the table is being resized, buckets with index < rehash_index of
+ * old_buckets were already moved to buckets; the rest still live in
+ * old_buckets. Each insert and delete moves up to HT_REHASH_STEP of them.
+ *
+ * occupied lists the buckets that became non-empty since the array was
+ * allocated or cleared, so ht_clear does not have to scan the array. A
+ * bucket emptied and filled again is listed twice; once the list is full,
+ * ht_clear falls back to zeroing the whole array.
+ *
+ * With a Bloom filter enabled (ht_enable_bloom) every key of the table is in
+ * the filter, and lookups of keys it rejects never touch a chain.
+ *
+ * In cache mode (ht_enable_cache) the table holds a bounded number of items
+ * and evicts the least recently used ones, see ht_cache_t.
+ *
+ * With a key pool (ht_enable_pool) the records hold only the items, their
+ * keys are stored in the pool (ht_pool.h).
+ */
+typedef struct ht_table {
+  ht_item_t **buckets;     // pole zoznamov synoným (NULL pred prvým vložením)
+  int size;                // počet prvkov poľa buckets
+  int *occupied;           // indexy neprázdnych zoznamov v buckets
+  int occupied_count;      // počet indexov v occupied (size = neznáme)
+  ht_item_t **old_buckets; // pôvodné pole počas presúvania, inak NULL
+  int old_size;            // počet prvkov poľa old_buckets
+  int rehash_index;        // prvý ešte nepresunutý prvok old_buckets
+  int min_size;            // veľkosť pod ktorú sa tabuľka nezmenší
+  int count;               // počet položiek v tabuľke
+  float max_load;          // hranica zväčšenia tabuľky
+  float min_load;          // hranica zmenšenia tabuľky
+  ht_arena_t arena;        // alokátor položiek
+  struct ht_bloom *bloom;  // filter neprítomných kľúčov, NULL ak je vypnutý
+  ht_cache_t *cache;       // režim vyrovnávacej pamäte, NULL ak je vypnutý
+  struct ht_pool *pool;    // zásobník kľúčov, NULL pre kľúče v záznamoch
+  bool pool_owned;         // zásobník patrí tabuľke
+#ifdef HT_STATS
+  ht_counters_t counters;  // počítadlá operácií
+#endif
+} ht_table_t;
+
+bool ht_enable_bloom(ht_table_t *table, float fpr, size_t max_bytes);
+void ht_disable_bloom(ht_table_t *table);
+bool ht_enable_cache(ht_table_t *table, int max_items, size_t max_bytes,
+                     ht_cache_policy_t policy);
+void ht_disable_cache(ht_table_t *table);
+bool ht_enable_pool(ht_table_t *table, struct ht_pool *pool);
+
+#endif
 
 int get_hash(char *key);
 void ht_init(ht_table_t *table);
 ht_item_t *ht_search(ht_table_t *table, char *key);
 void ht_insert(ht_table_t *table, char *key, float data);
 float *ht_get(ht_table_t *table, char *key);
+float *ht_upsert(ht_table_t *table, char *key, float value);
+float *ht_get_or_insert(ht_table_t *table, char *key, float value,
+                        bool *inserted);
+void ht_insert_many(ht_table_t *table, const ht_item_t items[], int count);
+void ht_get_many(ht_table_t *table, char *keys[], int count, float *values[]);
+uint64_t ht_scan(ht_table_t *table, uint64_t cursor,
+                 ht_scan_callback_t callback, void *data, int budget);
 void ht_delete(ht_table_t *table, char *key);
 void ht_delete_all(ht_table_t *table);
+void ht_clear(ht_table_t *table);
+void ht_stats(ht_table_t *table, ht_stats_t *stats);
 
 #endif
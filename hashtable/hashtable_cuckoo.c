@@ -0,0 +1,736 @@
+/*
+ * Tabuľka s rozptýlenými položkami — kukučie rozptýlenie
+ *
+ * Alternative engine with the same ht_* interface as hashtable.c, built with
+ * -DHT_CUCKOO (make test-cuckoo). Every key has two buckets of
+ * HT_CUCKOO_SLOTS slots and is always stored in one of them, so a lookup
+ * reads two cache lines whatever the keys are. An insert into two full
+ * buckets moves an item to its other bucket, which may move another one;
+ * after HT_CUCKOO_MAX_KICKS moves the item left over goes to the stash, and
+ * once the stash is full the table grows.
+ *
+ * The first bucket comes from the high bits of the hash like in the other
+ * engines, the second one from its low bits, at most HT_CUCKOO_WINDOW - 1
+ * buckets further. That keeps ht_scan exact: all items whose first bucket is
+ * in a range are found in the buckets just after it.
+ */
+
+#include "hashtable.h"
+#include "ht_hash.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+int HT_SIZE = HT_DEFAULT_SIZE;
+
+// Primary buckets ht_scan covers per call at most
+#define HT_CUCKOO_SCAN_BUCKETS 256
+
+/*
+ * Rozptyľovacia funkcia ktorá pridelí zadanému kľúču index z intervalu
+ * <0,HT_SIZE-1>.
+ *
+ * Kept for interface compatibility, the table itself uses ht_hash directly.
+ */
+int get_hash(char *key) {
+  return ht_hash_index(ht_hash(key, strlen(key)), HT_SIZE);
+}
+
+// First bucket of a hash, groups cover consecutive hash ranges
+static inline int ht_first(uint64_t hash, int buckets)
+{
+  return ht_hash_index(hash, buckets);
+}
+
+// Second bucket of a hash, 1 to HT_CUCKOO_WINDOW - 1 buckets after the first
+static inline int ht_second(uint64_t hash, int first, int buckets)
+{
+  int offset = 1 + (int)(((hash & 0xffffffffULL) * (HT_CUCKOO_WINDOW - 1)) >> 32);
+  return (first + offset) % buckets;
+}
+
+/*
+ * Rounds size up to a whole number of buckets.
+ */
+static int ht_slot_count(int size)
+{
+  if (size < HT_CUCKOO_SLOTS)
+    return HT_CUCKOO_SLOTS;
+  return (size + HT_CUCKOO_SLOTS - 1) / HT_CUCKOO_SLOTS * HT_CUCKOO_SLOTS;
+}
+
+/*
+ * xorshift32, picks the items moved by inserts. Seeded in ht_init so a table
+ * is built the same way every time.
+ */
+static inline uint32_t ht_random(ht_table_t *table)
+{
+  uint32_t x = table->random;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  table->random = x;
+  return x;
+}
+
+/*
+ * Returns the slot of the bucket holding key or NULL.
+ */
+static inline ht_item_t **ht_bucket_find(ht_table_t *table, ht_bucket_t *bucket,
+                                         const char *key, size_t length,
+                                         uint64_t hash)
+{
+  for (int i = 0; i < HT_CUCKOO_SLOTS; i++)
+  {
+    ht_item_t *item = bucket->items[i];
+    if (bucket->hashes[i] == hash && item != NULL)
+    {
+      HT_COUNT(table, comparisons, 1);
+      if (item->length == length && memcmp(item->key, key, length) == 0)
+        return &bucket->items[i];
+    }
+  }
+  return NULL;
+}
+
+/*
+ * Returns the slot (in a bucket or the stash) holding key or NULL.
+ */
+static ht_item_t **ht_find(ht_table_t *table, const char *key, size_t length,
+                           uint64_t hash)
+{
+  int buckets = table->size / HT_CUCKOO_SLOTS;
+  int first = ht_first(hash, buckets);
+
+  HT_COUNT(table, lookups, 1);
+
+  ht_item_t **slot = ht_bucket_find(table, &table->buckets[first], key, length, hash);
+  if (slot == NULL)
+    slot = ht_bucket_find(table, &table->buckets[ht_second(hash, first, buckets)],
+                          key, length, hash);
+
+  for (int i = 0; slot == NULL && i < table->stash_count; i++)
+  {
+    ht_item_t *item = table->stash[i];
+    if (item->hash == hash)
+    {
+      HT_COUNT(table, comparisons, 1);
+      if (item->length == length && memcmp(item->key, key, length) == 0)
+        slot = &table->stash[i];
+    }
+  }
+
+  if (slot != NULL)
+    HT_COUNT(table, hits, 1);
+  else
+    HT_COUNT(table, misses, 1);
+  return slot;
+}
+
+/*
+ * Stores item into a free slot of the bucket, returns false if it is full.
+ */
+static inline bool ht_bucket_put(ht_bucket_t *bucket, ht_item_t *item)
+{
+  for (int i = 0; i < HT_CUCKOO_SLOTS; i++)
+  {
+    if (bucket->items[i] == NULL)
+    {
+      bucket->items[i] = item;
+      bucket->hashes[i] = item->hash;
+      return true;
+    }
+  }
+  return false;
+}
+
+/*
+ * Stores item into one of its buckets. When both are full a random item of
+ * one of them is replaced and moved to its other bucket the same way, never
+ * straight back to the bucket it was just pushed out of.
+ *
+ * Returns NULL, or the item left without a slot after HT_CUCKOO_MAX_KICKS
+ * moves (not necessarily item).
+ */
+static ht_item_t *ht_place(ht_table_t *table, ht_item_t *item)
+{
+  int buckets = table->size / HT_CUCKOO_SLOTS;
+  int from = -1;
+
+  for (int kick = 0; ; kick++)
+  {
+    int first = ht_first(item->hash, buckets);
+    int second = ht_second(item->hash, first, buckets);
+    if (ht_bucket_put(&table->buckets[first], item) ||
+        ht_bucket_put(&table->buckets[second], item))
+      return NULL;
+
+    if (kick == HT_CUCKOO_MAX_KICKS)
+      return item;
+
+    uint32_t random = ht_random(table);
+    int victim;
+    if (first == from)
+      victim = second;
+    else if (second == from)
+      victim = first;
+    else
+      victim = random & 1 ? second : first;
+
+    ht_bucket_t *bucket = &table->buckets[victim];
+    int slot = (random >> 1) % HT_CUCKOO_SLOTS;
+    ht_item_t *evicted = bucket->items[slot];
+    bucket->items[slot] = item;
+    bucket->hashes[slot] = item->hash;
+
+    item = evicted;
+    from = victim;
+  }
+}
+
+/*
+ * Moves items of the stash into buckets that have a free slot now.
+ */
+static void ht_unstash(ht_table_t *table)
+{
+  int buckets = table->size / HT_CUCKOO_SLOTS;
+
+  for (int i = 0; i < table->stash_count;)
+  {
+    ht_item_t *item = table->stash[i];
+    int first = ht_first(item->hash, buckets);
+    if (ht_bucket_put(&table->buckets[first], item) ||
+        ht_bucket_put(&table->buckets[ht_second(item->hash, first, buckets)], item))
+      table->stash[i] = table->stash[--table->stash_count];
+    else
+      i++;
+  }
+}
+
+/*
+ * Allocates an empty bucket array for size slots.
+ */
+static ht_bucket_t *ht_alloc(int size)
+{
+  size_t bytes = size / HT_CUCKOO_SLOTS * sizeof(ht_bucket_t);
+  ht_bucket_t *buckets = (ht_bucket_t*)aligned_alloc(_Alignof(ht_bucket_t), bytes);
+  if (buckets != NULL)
+    memset(buckets, 0, bytes);
+  return buckets;
+}
+
+/*
+ * Places all items into new buckets of new_size slots. If they do not fit
+ * the size is doubled until they do. Returns false, with the table
+ * unchanged, if the memory could not be allocated.
+ */
+static bool ht_resize(ht_table_t *table, int new_size)
+{
+  for (;;)
+  {
+    ht_table_t grown = *table;
+    grown.buckets = ht_alloc(new_size);
+    grown.size = new_size;
+    grown.stash_count = 0;
+    if (grown.buckets == NULL) return false;
+
+    bool placed = true;
+    for (int i = 0; placed && i < table->size / HT_CUCKOO_SLOTS; i++)
+    {
+      for (int j = 0; placed && j < HT_CUCKOO_SLOTS; j++)
+      {
+        ht_item_t *item = table->buckets[i].items[j];
+        if (item == NULL) continue;
+
+        item = ht_place(&grown, item);
+        if (item != NULL && grown.stash_count < HT_CUCKOO_STASH)
+          grown.stash[grown.stash_count++] = item;
+        else if (item != NULL)
+          placed = false;
+      }
+    }
+    for (int i = 0; placed && i < table->stash_count; i++)
+    {
+      ht_item_t *item = ht_place(&grown, table->stash[i]);
+      if (item != NULL && grown.stash_count < HT_CUCKOO_STASH)
+        grown.stash[grown.stash_count++] = item;
+      else if (item != NULL)
+        placed = false;
+    }
+
+    if (placed)
+    {
+      free(table->buckets);
+      *table = grown;
+      return true;
+    }
+
+    free(grown.buckets);
+    new_size *= 2;
+  }
+}
+
+/*
+ * Inicializácia tabuľky — zavolá sa pred prvým použitím tabuľky.
+ *
+ * Skupiny sa alokujú až pri prvom vložení.
+ */
+void ht_init(ht_table_t *table)
+{
+  if (table == NULL) return;
+
+  table->buckets = NULL;
+  table->size = ht_slot_count(HT_SIZE);
+  table->min_size = table->size;
+  table->count = 0;
+  table->stash_count = 0;
+  table->random = 0x9e3779b9u;
+  table->max_load = HT_CUCKOO_MAX_LOAD;
+  table->min_load = HT_MIN_LOAD;
+#ifdef HT_STATS
+  memset(&table->counters, 0, sizeof(table->counters));
+#endif
+}
+
+/*
+ * Vyhľadanie prvku v tabuľke.
+ *
+ * V prípade úspechu vráti ukazovateľ na nájdený prvok; v opačnom prípade vráti
+ * hodnotu NULL.
+ */
+ht_item_t *ht_search(ht_table_t *table, char *key)
+{
+  if (table == NULL || table->buckets == NULL) return NULL;
+
+  size_t length = strlen(key);
+  ht_item_t **slot = ht_find(table, key, length, ht_hash(key, length));
+  return slot != NULL ? *slot : NULL;
+}
+
+/*
+ * Inserts the key with an already computed length and hash, or finds it.
+ *
+ * An existing item gets value only if overwrite is set. Returns the value
+ * of the item, or NULL when the item could not be created.
+ *
+ * The table grows before the insert when it is over its load limit or when
+ * the stash has no room for an item the insert might leave over.
+ */
+static float *ht_put_hashed(ht_table_t *table, char *key, size_t length,
+                            uint64_t hash, float value, bool overwrite,
+                            bool *inserted)
+{
+  ht_item_t **slot = ht_find(table, key, length, hash);
+  if (slot != NULL)
+  {
+    if (overwrite)
+      (*slot)->value = value;
+    return &(*slot)->value;
+  }
+
+  if (table->count + 1 > table->size * table->max_load ||
+      table->stash_count == HT_CUCKOO_STASH)
+  {
+    if (!ht_resize(table, table->size * 2) &&
+        table->stash_count == HT_CUCKOO_STASH)
+      return NULL;
+  }
+
+  ht_item_t *item = (ht_item_t*)malloc(sizeof(ht_item_t) + length + 1);
+  if (item == NULL) return NULL;
+
+  item->key = (char*)(item + 1);
+  memcpy(item->key, key, length + 1);
+  item->value = value;
+  item->length = (unsigned)length;
+  item->next = NULL;
+  item->hash = hash;
+
+  ht_item_t *left = ht_place(table, item);
+  if (left != NULL)
+    table->stash[table->stash_count++] = left;
+
+  table->count++;
+  if (inserted != NULL)
+    *inserted = true;
+
+  return &item->value;
+}
+
+/*
+ * Looks the key up and inserts it when missing, hashing it only once.
+ */
+static float *ht_put(ht_table_t *table, char *key, float value,
+                     bool overwrite, bool *inserted)
+{
+  if (inserted != NULL)
+    *inserted = false;
+  if (table == NULL) return NULL;
+
+  if (table->buckets == NULL)
+  {
+    table->buckets = ht_alloc(table->size);
+    if (table->buckets == NULL) return NULL;
+  }
+
+  size_t length = strlen(key);
+  return ht_put_hashed(table, key, length, ht_hash(key, length), value,
+                       overwrite, inserted);
+}
+
+/*
+ * Vloženie nového prvku do tabuľky.
+ *
+ * Pokiaľ prvok s daným kľúčom už v tabuľke existuje, nahraďte jeho hodnotu.
+ */
+void ht_insert(ht_table_t *table, char *key, float value)
+{
+  ht_put(table, key, value, true, NULL);
+}
+
+/*
+ * Vloženie alebo prepísanie prvku jedným prechodom tabuľkou.
+ *
+ * Returns a pointer to the value of the item, valid until the item is
+ * deleted, or NULL if the item could not be created.
+ */
+float *ht_upsert(ht_table_t *table, char *key, float value)
+{
+  return ht_put(table, key, value, true, NULL);
+}
+
+/*
+ * Získanie hodnoty prvku, ktorý sa v prípade potreby vloží.
+ *
+ * A missing key is inserted with value, an existing item keeps its value.
+ */
+float *ht_get_or_insert(ht_table_t *table, char *key, float value,
+                        bool *inserted)
+{
+  return ht_put(table, key, value, false, inserted);
+}
+
+/*
+ * Získanie hodnoty z tabuľky.
+ *
+ * V prípade úspechu vráti funkcia ukazovateľ na hodnotu prvku, v opačnom
+ * prípade hodnotu NULL.
+ */
+float *ht_get(ht_table_t *table, char *key)
+{
+  ht_item_t *item = ht_search(table, key);
+  if (item != NULL) return &item->value;
+  return NULL;
+}
+
+/*
+ * Hromadné vloženie prvkov do tabuľky.
+ *
+ * The table is sized for all items up front, then keys are hashed a batch at
+ * a time (ht_hash_many) and both buckets of every key of the batch are
+ * prefetched before inserting.
+ */
+void ht_insert_many(ht_table_t *table, const ht_item_t items[], int count)
+{
+  if (table == NULL) return;
+
+  int size = table->size;
+  while (table->count + count > size * table->max_load)
+  {
+    size *= 2;
+  }
+
+  if (table->buckets == NULL)
+  {
+    table->buckets = ht_alloc(size);
+    if (table->buckets == NULL) return;
+    table->size = size;
+  }
+  else if (size != table->size)
+  {
+    ht_resize(table, size);
+  }
+
+  const char *keys[HT_BATCH_SIZE];
+  size_t lengths[HT_BATCH_SIZE];
+  uint64_t hashes[HT_BATCH_SIZE];
+
+  for (int start = 0; start < count; start += HT_BATCH_SIZE)
+  {
+    int batch = count - start < HT_BATCH_SIZE ? count - start : HT_BATCH_SIZE;
+    int buckets = table->size / HT_CUCKOO_SLOTS;
+
+    for (int i = 0; i < batch; i++)
+    {
+      keys[i] = items[start + i].key;
+      lengths[i] = strlen(keys[i]);
+    }
+    ht_hash_many(keys, lengths, batch, hashes);
+
+    for (int i = 0; i < batch; i++)
+    {
+      int first = ht_first(hashes[i], buckets);
+      __builtin_prefetch(&table->buckets[first]);
+      __builtin_prefetch(&table->buckets[ht_second(hashes[i], first, buckets)]);
+    }
+
+    for (int i = 0; i < batch; i++)
+    {
+      ht_put_hashed(table, items[start + i].key, lengths[i], hashes[i],
+                    items[start + i].value, true, NULL);
+    }
+  }
+}
+
+/*
+ * Hromadné získanie hodnôt z tabuľky.
+ *
+ * values[i] is set to what ht_get(table, keys[i]) would return. All keys of a
+ * batch are hashed first (ht_hash_many) and both buckets of each are
+ * prefetched, so the misses of the batch overlap.
+ */
+void ht_get_many(ht_table_t *table, char *keys[], int count, float *values[])
+{
+  if (table == NULL || table->buckets == NULL)
+  {
+    for (int i = 0; i < count; i++)
+    {
+      values[i] = NULL;
+    }
+    return;
+  }
+
+  size_t lengths[HT_BATCH_SIZE];
+  uint64_t hashes[HT_BATCH_SIZE];
+  int buckets = table->size / HT_CUCKOO_SLOTS;
+
+  for (int start = 0; start < count; start += HT_BATCH_SIZE)
+  {
+    int batch = count - start < HT_BATCH_SIZE ? count - start : HT_BATCH_SIZE;
+
+    for (int i = 0; i < batch; i++)
+    {
+      lengths[i] = strlen(keys[start + i]);
+    }
+    ht_hash_many((const char **)&keys[start], lengths, batch, hashes);
+
+    for (int i = 0; i < batch; i++)
+    {
+      int first = ht_first(hashes[i], buckets);
+      __builtin_prefetch(&table->buckets[first]);
+      __builtin_prefetch(&table->buckets[ht_second(hashes[i], first, buckets)]);
+    }
+
+    for (int i = 0; i < batch; i++)
+    {
+      ht_item_t **slot = ht_find(table, keys[start + i], lengths[i], hashes[i]);
+      values[start + i] = slot != NULL ? &(*slot)->value : NULL;
+    }
+  }
+}
+
+/*
+ * Visits the items whose hash position is at least cursor and whose first
+ * bucket lies in <first,first+count). They are in the buckets from first up
+ * to HT_CUCKOO_WINDOW - 1 after the range, or in the stash. With counts set
+ * the items are counted per first bucket, otherwise passed to callback.
+ */
+static void ht_scan_range(ht_table_t *table, int first, int count,
+                          uint64_t cursor, int counts[],
+                          ht_scan_callback_t callback, void *data)
+{
+  int buckets = table->size / HT_CUCKOO_SLOTS;
+  int window = count + HT_CUCKOO_WINDOW - 1;
+  if (window > buckets)
+    window = buckets;
+
+  for (int i = 0; i <= window; i++)
+  {
+    ht_item_t **items = i < window ? table->buckets[(first + i) % buckets].items
+                                   : table->stash;
+    int slots = i < window ? HT_CUCKOO_SLOTS : table->stash_count;
+
+    for (int j = 0; j < slots; j++)
+    {
+      ht_item_t *item = items[j];
+      if (item == NULL || item->hash >> 32 < cursor) continue;
+
+      int bucket = ht_first(item->hash, buckets);
+      if (bucket < first || bucket >= first + count) continue;
+
+      if (counts != NULL)
+        counts[bucket - first]++;
+      else if (callback != NULL)
+        callback(item, data);
+    }
+  }
+}
+
+/*
+ * Postupný prechod všetkými prvkami tabuľky.
+ *
+ * Start with cursor 0 and call again with the returned cursor until it is 0.
+ * The cursor is a hash position (see ht_hash_position); each call takes the
+ * first buckets upwards from it and passes the items that have them as their
+ * first bucket to callback, wherever they are stored, at most budget items
+ * unless the first bucket alone has more. An item present during the whole
+ * scan is visited exactly once even if the table is modified or resized
+ * between calls. The callback must not modify the table.
+ */
+uint64_t ht_scan(ht_table_t *table, uint64_t cursor,
+                 ht_scan_callback_t callback, void *data, int budget)
+{
+  if (table == NULL || table->buckets == NULL) return 0;
+
+  int buckets = table->size / HT_CUCKOO_SLOTS;
+  int first = ht_first(cursor << 32, buckets);
+  int count = budget * HT_SCAN_BUCKETS;
+  if (count < 1)
+    count = 1;
+  if (count > HT_CUCKOO_SCAN_BUCKETS)
+    count = HT_CUCKOO_SCAN_BUCKETS;
+  if (count > buckets - first)
+    count = buckets - first;
+
+  int counts[HT_CUCKOO_SCAN_BUCKETS] = {0};
+  ht_scan_range(table, first, count, cursor, counts, NULL, NULL);
+
+  int taken = 0;
+  int visited = 0;
+  while (taken < count && (taken == 0 || visited + counts[taken] <= budget))
+  {
+    visited += counts[taken++];
+    if (visited >= budget)
+      break;
+  }
+
+  ht_scan_range(table, first, taken, cursor, NULL, callback, data);
+
+  cursor = ht_hash_position(first + taken, buckets);
+  return cursor < HT_HASH_POSITIONS ? cursor : 0;
+}
+
+/*
+ * Zmazanie prvku z tabuľky.
+ *
+ * Funkcia korektne uvoľní všetky alokované zdroje priradené k danému prvku.
+ * Pokiaľ prvok neexistuje, nerobte nič.
+ *
+ * The freed slot may take an item waiting in the stash.
+ */
+void ht_delete(ht_table_t *table, char *key)
+{
+  if (table == NULL || table->buckets == NULL) return;
+
+  size_t length = strlen(key);
+  ht_item_t **slot = ht_find(table, key, length, ht_hash(key, length));
+  if (slot == NULL) return;
+
+  free(*slot);
+  table->count--;
+
+  if (slot >= table->stash && slot < table->stash + HT_CUCKOO_STASH)
+  {
+    *slot = table->stash[--table->stash_count];
+  }
+  else
+  {
+    *slot = NULL;
+    ht_unstash(table);
+  }
+
+  if (table->size > table->min_size &&
+      table->count < table->min_load * table->size)
+  {
+    ht_resize(table, table->size / 2);
+  }
+}
+
+/*
+ * Frees all items of the table.
+ */
+static void ht_free_items(ht_table_t *table)
+{
+  for (int i = 0; i < table->size / HT_CUCKOO_SLOTS; i++)
+  {
+    for (int j = 0; j < HT_CUCKOO_SLOTS; j++)
+      free(table->buckets[i].items[j]);
+  }
+  for (int i = 0; i < table->stash_count; i++)
+    free(table->stash[i]);
+}
+
+/*
+ * Zmazanie všetkých prvkov z tabuľky.
+ *
+ * Funkcia korektne uvoľní všetky alokované zdroje a uvedie tabuľku do stavu po
+ * inicializácii.
+ */
+void ht_delete_all(ht_table_t *table)
+{
+  if (table == NULL) return;
+
+  if (table->buckets != NULL)
+    ht_free_items(table);
+  free(table->buckets);
+
+  table->buckets = NULL;
+  table->size = table->min_size;
+  table->count = 0;
+  table->stash_count = 0;
+}
+
+/*
+ * Vyprázdnenie tabuľky bez uvoľnenia jej pamäte.
+ *
+ * The bucket array keeps its size. Items are allocated one by one, so every
+ * slot is still visited to free them; the array is then zeroed with one
+ * memset.
+ */
+void ht_clear(ht_table_t *table)
+{
+  if (table == NULL || table->buckets == NULL) return;
+
+  ht_free_items(table);
+  memset(table->buckets, 0, table->size / HT_CUCKOO_SLOTS * sizeof(ht_bucket_t));
+  table->count = 0;
+  table->stash_count = 0;
+}
+
+/*
+ * Štatistika tabuľky.
+ *
+ * A chain is the items stored in one bucket, so no chain is longer than
+ * HT_CUCKOO_SLOTS. Items in the stash count only to items. Counters are
+ * copied only with -DHT_STATS, otherwise zero.
+ */
+void ht_stats(ht_table_t *table, ht_stats_t *stats)
+{
+  memset(stats, 0, sizeof(*stats));
+  if (table == NULL) return;
+
+  stats->buckets = table->size / HT_CUCKOO_SLOTS;
+  for (int i = 0; i < stats->buckets; i++)
+  {
+    int length = 0;
+    for (int j = 0; table->buckets != NULL && j < HT_CUCKOO_SLOTS; j++)
+    {
+      if (table->buckets[i].items[j] != NULL)
+        length++;
+    }
+
+    stats->items += length;
+    if (length == 0)
+      stats->empty_buckets++;
+    if (length > stats->max_chain)
+      stats->max_chain = length;
+    stats->chains[length < HT_STATS_CHAINS ? length : HT_STATS_CHAINS - 1]++;
+  }
+
+  if (table->buckets != NULL)
+    stats->items += table->stash_count;
+  stats->load_factor = (float)stats->items / table->size;
+#ifdef HT_STATS
+  stats->counters = table->counters;
+#endif
+}
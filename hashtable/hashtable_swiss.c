@@ -0,0 +1,674 @@
+/*
+ * Tabuľka s rozptýlenými položkami — otvorené adresovanie
+ *
+ * Alternative engine with the same ht_* interface as hashtable.c, built with
+ * -DHT_SWISS (make test-swiss). Items live in one flat slot array; a parallel
+ * array of control bytes keeps 7 bits of every key's hash. Lookups probe the
+ * table group by group and compare HT_GROUP_SIZE control bytes with a single
+ * SSE2 instruction, so most non-matching slots are skipped without touching
+ * their keys.
+ */
+
+#include "hashtable.h"
+#include "ht_hash.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+int HT_SIZE = HT_DEFAULT_SIZE;
+
+/*
+ * Rozptyľovacia funkcia ktorá pridelí zadanému kľúču index z intervalu
+ * <0,HT_SIZE-1>.
+ *
+ * Kept for interface compatibility, the table itself uses ht_hash directly.
+ */
+int get_hash(char *key) {
+  return ht_hash_index(ht_hash(key, strlen(key)), HT_SIZE);
+}
+
+// Control byte stored for a full slot (0..127)
+static inline signed char ht_h2(uint64_t hash)
+{
+  return (signed char)(hash & 0x7f);
+}
+
+// Group where the probe sequence of a hash starts, taken from the high bits
+// so that groups cover consecutive hash ranges (ht_scan relies on it)
+static inline int ht_h1(uint64_t hash, int groups)
+{
+  return ht_hash_index(hash, groups);
+}
+
+/*
+ * Returns a bit mask of the slots in the group whose control byte is value.
+ */
+static inline unsigned ht_group_match(const signed char *ctrl, signed char value)
+{
+#ifdef __SSE2__
+  __m128i group = _mm_loadu_si128((const __m128i*)ctrl);
+  return (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(value)));
+#else
+  unsigned mask = 0;
+  for (int i = 0; i < HT_GROUP_SIZE; i++)
+  {
+    if (ctrl[i] == value)
+      mask |= 1u << i;
+  }
+  return mask;
+#endif
+}
+
+/*
+ * Returns a bit mask of the empty and deleted slots in the group. Both have
+ * the sign bit set, full slots never do.
+ */
+static inline unsigned ht_group_match_free(const signed char *ctrl)
+{
+#ifdef __SSE2__
+  return (unsigned)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)ctrl));
+#else
+  unsigned mask = 0;
+  for (int i = 0; i < HT_GROUP_SIZE; i++)
+  {
+    if (ctrl[i] < 0)
+      mask |= 1u << i;
+  }
+  return mask;
+#endif
+}
+
+/*
+ * Rounds size up to a power of two number of groups.
+ */
+static int ht_slot_count(int size)
+{
+  int slots = HT_GROUP_SIZE;
+  while (slots < size)
+  {
+    slots *= 2;
+  }
+  return slots;
+}
+
+/*
+ * Returns the slot index holding key or -1. The probe visits groups in
+ * triangular order, which covers every group of a power of two table, and
+ * stops at the first group that has an empty slot.
+ */
+static int ht_find(ht_table_t *table, const char *key, size_t length,
+                   uint64_t hash)
+{
+  int groups = table->size / HT_GROUP_SIZE;
+  int group = ht_h1(hash, groups);
+  signed char h2 = ht_h2(hash);
+
+  HT_COUNT(table, lookups, 1);
+
+  for (int step = 1; step <= groups; step++)
+  {
+    const signed char *ctrl = &table->ctrl[group * HT_GROUP_SIZE];
+
+    unsigned mask = ht_group_match(ctrl, h2);
+    while (mask != 0)
+    {
+      int slot = group * HT_GROUP_SIZE + __builtin_ctz(mask);
+      ht_item_t *item = &table->slots[slot];
+      HT_COUNT(table, comparisons, 1);
+      if (item->hash == hash && item->length == length &&
+          memcmp(item->key, key, length) == 0)
+      {
+        HT_COUNT(table, hits, 1);
+        return slot;
+      }
+
+      mask &= mask - 1;
+    }
+
+    if (ht_group_match(ctrl, HT_CTRL_EMPTY) != 0)
+      break;
+
+    group = (group + step) & (groups - 1);
+  }
+
+  HT_COUNT(table, misses, 1);
+  return -1;
+}
+
+/*
+ * Returns the first empty or deleted slot on the probe sequence of hash.
+ * The table always has at least one such slot.
+ */
+static int ht_find_free(ht_table_t *table, uint64_t hash)
+{
+  int groups = table->size / HT_GROUP_SIZE;
+  int group = ht_h1(hash, groups);
+
+  for (int step = 1; ; step++)
+  {
+    unsigned mask = ht_group_match_free(&table->ctrl[group * HT_GROUP_SIZE]);
+    if (mask != 0)
+      return group * HT_GROUP_SIZE + __builtin_ctz(mask);
+
+    group = (group + step) & (groups - 1);
+  }
+}
+
+/*
+ * Allocates empty control and slot arrays of the given size.
+ */
+static bool ht_alloc(ht_table_t *table, int size)
+{
+  signed char *ctrl = (signed char*)malloc(size);
+  ht_item_t *slots = (ht_item_t*)malloc(size * sizeof(ht_item_t));
+  if (ctrl == NULL || slots == NULL)
+  {
+    free(ctrl);
+    free(slots);
+    return false;
+  }
+
+  memset(ctrl, HT_CTRL_EMPTY, size);
+
+  table->ctrl = ctrl;
+  table->slots = slots;
+  table->size = size;
+  table->growth_left = (int)(size * table->max_load) - table->count;
+  return true;
+}
+
+/*
+ * Moves all items to new arrays of new_size slots, dropping all tombstones.
+ * If the allocation fails the table is left unchanged and false is returned.
+ */
+static bool ht_resize(ht_table_t *table, int new_size)
+{
+  signed char *old_ctrl = table->ctrl;
+  ht_item_t *old_slots = table->slots;
+  int old_size = table->size;
+
+  if (!ht_alloc(table, new_size)) return false;
+
+  for (int i = 0; i < old_size; i++)
+  {
+    if (old_ctrl[i] >= 0)
+    {
+      int slot = ht_find_free(table, old_slots[i].hash);
+      table->ctrl[slot] = ht_h2(old_slots[i].hash);
+      table->slots[slot] = old_slots[i];
+    }
+  }
+
+  free(old_ctrl);
+  free(old_slots);
+  return true;
+}
+
+/*
+ * Inicializácia tabuľky — zavolá sa pred prvým použitím tabuľky.
+ *
+ * Sloty sa alokujú až pri prvom vložení.
+ */
+void ht_init(ht_table_t *table)
+{
+  if (table == NULL) return;
+
+  table->ctrl = NULL;
+  table->slots = NULL;
+  table->size = ht_slot_count(HT_SIZE);
+  table->min_size = table->size;
+  table->count = 0;
+  table->growth_left = 0;
+  table->max_load = HT_SWISS_MAX_LOAD;
+  table->min_load = HT_MIN_LOAD;
+#ifdef HT_STATS
+  memset(&table->counters, 0, sizeof(table->counters));
+#endif
+}
+
+/*
+ * Vyhľadanie prvku v tabuľke.
+ *
+ * V prípade úspechu vráti ukazovateľ na nájdený prvok; v opačnom prípade vráti
+ * hodnotu NULL.
+ */
+ht_item_t *ht_search(ht_table_t *table, char *key)
+{
+  if (table == NULL || table->ctrl == NULL) return NULL;
+
+  size_t length = strlen(key);
+  int slot = ht_find(table, key, length, ht_hash(key, length));
+  if (slot < 0) return NULL;
+  return &table->slots[slot];
+}
+
+/*
+ * Inserts the key with an already computed length and hash, or finds it.
+ *
+ * An existing item gets value only if overwrite is set. Returns the value
+ * slot of the item, or NULL when the key could not be copied.
+ *
+ * When no empty slot is left before the load limit, the table is rebuilt:
+ * doubled if it is really full, at the same size if the space is taken by
+ * tombstones. If the rebuild fails the key is not inserted and NULL is
+ * returned too, so the table never fills past the load limit.
+ */
+static float *ht_put_hashed(ht_table_t *table, char *key, size_t length,
+                            uint64_t hash, float value, bool overwrite,
+                            bool *inserted)
+{
+  int slot = ht_find(table, key, length, hash);
+  if (slot >= 0)
+  {
+    if (overwrite)
+      table->slots[slot].value = value;
+    return &table->slots[slot].value;
+  }
+
+  char *copy = (char*)malloc((length + 1) * sizeof(char));
+  if (copy == NULL) return NULL;
+  memcpy(copy, key, length + 1);
+
+  slot = ht_find_free(table, hash);
+  if (table->growth_left <= 0 && table->ctrl[slot] == HT_CTRL_EMPTY)
+  {
+    bool resized;
+    if (table->count + 1 > table->size * table->max_load)
+      resized = ht_resize(table, table->size * 2);
+    else
+      resized = ht_resize(table, table->size);
+
+    if (!resized)
+    {
+      free(copy);
+      return NULL;
+    }
+
+    slot = ht_find_free(table, hash);
+  }
+
+  if (table->ctrl[slot] == HT_CTRL_EMPTY)
+    table->growth_left--;
+
+  ht_item_t *item = &table->slots[slot];
+  table->ctrl[slot] = ht_h2(hash);
+  item->key = copy;
+  item->value = value;
+  item->length = (unsigned)length;
+  item->next = NULL;
+  item->hash = hash;
+  table->count++;
+  if (inserted != NULL)
+    *inserted = true;
+
+  return &item->value;
+}
+
+/*
+ * Looks the key up and inserts it when missing, hashing it only once.
+ */
+static float *ht_put(ht_table_t *table, char *key, float value,
+                     bool overwrite, bool *inserted)
+{
+  if (inserted != NULL)
+    *inserted = false;
+  if (table == NULL) return NULL;
+
+  if (table->ctrl == NULL && !ht_alloc(table, table->size)) return NULL;
+
+  size_t length = strlen(key);
+  return ht_put_hashed(table, key, length, ht_hash(key, length), value,
+                       overwrite, inserted);
+}
+
+/*
+ * Vloženie nového prvku do tabuľky.
+ *
+ * Pokiaľ prvok s daným kľúčom už v tabuľke existuje, nahraďte jeho hodnotu.
+ */
+void ht_insert(ht_table_t *table, char *key, float value)
+{
+  ht_put(table, key, value, true, NULL);
+}
+
+/*
+ * Vloženie alebo prepísanie prvku jedným prechodom tabuľkou.
+ *
+ * Returns a pointer to the value of the item, valid until the next insert or
+ * delete, or NULL if the item could not be created.
+ */
+float *ht_upsert(ht_table_t *table, char *key, float value)
+{
+  return ht_put(table, key, value, true, NULL);
+}
+
+/*
+ * Získanie hodnoty prvku, ktorý sa v prípade potreby vloží.
+ *
+ * A missing key is inserted with value, an existing item keeps its value.
+ * The returned pointer is valid until the next insert or delete.
+ */
+float *ht_get_or_insert(ht_table_t *table, char *key, float value,
+                        bool *inserted)
+{
+  return ht_put(table, key, value, false, inserted);
+}
+
+/*
+ * Získanie hodnoty z tabuľky.
+ *
+ * V prípade úspechu vráti funkcia ukazovateľ na hodnotu prvku, v opačnom
+ * prípade hodnotu NULL.
+ */
+float *ht_get(ht_table_t *table, char *key)
+{
+  ht_item_t *item = ht_search(table, key);
+  if (item != NULL) return &item->value;
+  return NULL;
+}
+
+/*
+ * Hromadné vloženie prvkov do tabuľky.
+ *
+ * The table is sized for all items up front, then keys are hashed a batch at
+ * a time (ht_hash_many) and the control groups of the batch are prefetched
+ * before inserting.
+ */
+void ht_insert_many(ht_table_t *table, const ht_item_t items[], int count)
+{
+  if (table == NULL) return;
+
+  int size = table->size;
+  while (table->count + count > size * table->max_load)
+  {
+    size *= 2;
+  }
+
+  if (table->ctrl == NULL)
+  {
+    table->size = size;
+    if (!ht_alloc(table, table->size)) return;
+  }
+  else if (size != table->size)
+  {
+    ht_resize(table, size);
+  }
+
+  const char *keys[HT_BATCH_SIZE];
+  size_t lengths[HT_BATCH_SIZE];
+  uint64_t hashes[HT_BATCH_SIZE];
+
+  for (int start = 0; start < count; start += HT_BATCH_SIZE)
+  {
+    int batch = count - start < HT_BATCH_SIZE ? count - start : HT_BATCH_SIZE;
+    int groups = table->size / HT_GROUP_SIZE;
+
+    for (int i = 0; i < batch; i++)
+    {
+      keys[i] = items[start + i].key;
+      lengths[i] = strlen(keys[i]);
+    }
+    ht_hash_many(keys, lengths, batch, hashes);
+
+    for (int i = 0; i < batch; i++)
+    {
+      __builtin_prefetch(&table->ctrl[ht_h1(hashes[i], groups) * HT_GROUP_SIZE]);
+    }
+
+    for (int i = 0; i < batch; i++)
+    {
+      ht_put_hashed(table, items[start + i].key, lengths[i], hashes[i],
+                    items[start + i].value, true, NULL);
+    }
+  }
+}
+
+/*
+ * Hromadné získanie hodnôt z tabuľky.
+ *
+ * values[i] is set to what ht_get(table, keys[i]) would return. All keys of a
+ * batch are hashed first (ht_hash_many) and the control group and first slot
+ * of each probe are prefetched, so the misses of the batch overlap.
+ */
+void ht_get_many(ht_table_t *table, char *keys[], int count, float *values[])
+{
+  if (table == NULL || table->ctrl == NULL)
+  {
+    for (int i = 0; i < count; i++)
+    {
+      values[i] = NULL;
+    }
+    return;
+  }
+
+  size_t lengths[HT_BATCH_SIZE];
+  uint64_t hashes[HT_BATCH_SIZE];
+  int groups = table->size / HT_GROUP_SIZE;
+
+  for (int start = 0; start < count; start += HT_BATCH_SIZE)
+  {
+    int batch = count - start < HT_BATCH_SIZE ? count - start : HT_BATCH_SIZE;
+
+    for (int i = 0; i < batch; i++)
+    {
+      lengths[i] = strlen(keys[start + i]);
+    }
+    ht_hash_many((const char **)&keys[start], lengths, batch, hashes);
+
+    for (int i = 0; i < batch; i++)
+    {
+      int first = ht_h1(hashes[i], groups) * HT_GROUP_SIZE;
+      __builtin_prefetch(&table->ctrl[first]);
+      __builtin_prefetch(&table->slots[first]);
+    }
+
+    for (int i = 0; i < batch; i++)
+    {
+      int slot = ht_find(table, keys[start + i], lengths[i], hashes[i]);
+      values[start + i] = slot >= 0 ? &table->slots[slot].value : NULL;
+    }
+  }
+}
+
+/*
+ * Counts the items whose probe sequence starts in group and whose hash
+ * position lies in <start,end), and passes them to callback unless it is
+ * NULL. Like ht_find it follows the probe sequence up to the first group with
+ * an empty slot.
+ */
+static int ht_scan_group(ht_table_t *table, int group, uint64_t start,
+                         uint64_t end, ht_scan_callback_t callback, void *data)
+{
+  int groups = table->size / HT_GROUP_SIZE;
+  int count = 0;
+
+  for (int step = 1; step <= groups; step++)
+  {
+    const signed char *ctrl = &table->ctrl[group * HT_GROUP_SIZE];
+
+    for (int i = 0; i < HT_GROUP_SIZE; i++)
+    {
+      ht_item_t *item = &table->slots[group * HT_GROUP_SIZE + i];
+      if (ctrl[i] >= 0 && item->hash >> 32 >= start && item->hash >> 32 < end)
+      {
+        if (callback != NULL)
+          callback(item, data);
+        count++;
+      }
+    }
+
+    if (ht_group_match(ctrl, HT_CTRL_EMPTY) != 0)
+      break;
+
+    group = (group + step) & (groups - 1);
+  }
+
+  return count;
+}
+
+/*
+ * Postupný prechod všetkými prvkami tabuľky.
+ *
+ * Start with cursor 0 and call again with the returned cursor until it is 0.
+ * The cursor is a hash position (see ht_hash_position); each call takes the
+ * home groups upwards from it and passes their items to callback, at most
+ * budget items unless the first group alone has more. An item present during
+ * the whole scan is visited exactly once even if the table is modified or
+ * resized between calls. The callback must not modify the table.
+ */
+uint64_t ht_scan(ht_table_t *table, uint64_t cursor,
+                 ht_scan_callback_t callback, void *data, int budget)
+{
+  if (table == NULL || table->ctrl == NULL) return 0;
+
+  int groups = table->size / HT_GROUP_SIZE;
+  int visited = 0;
+  int visited_groups = 0;
+
+  while (cursor < HT_HASH_POSITIONS)
+  {
+    int group = ht_h1(cursor << 32, groups);
+    uint64_t end = ht_hash_position(group + 1, groups);
+
+    int count = ht_scan_group(table, group, cursor, end, NULL, NULL);
+    if (visited > 0 && visited + count > budget)
+      break;
+
+    ht_scan_group(table, group, cursor, end, callback, data);
+    visited += count;
+    cursor = end;
+
+    if (visited >= budget || ++visited_groups >= budget * HT_SCAN_BUCKETS)
+      break;
+  }
+
+  return cursor < HT_HASH_POSITIONS ? cursor : 0;
+}
+
+/*
+ * Zmazanie prvku z tabuľky.
+ *
+ * Funkcia korektne uvoľní všetky alokované zdroje priradené k danému prvku.
+ * Pokiaľ prvok neexistuje, nerobte nič.
+ *
+ * A slot in a group that still has an empty slot can become empty again
+ * (every probe stops in that group anyway); otherwise it is marked deleted.
+ */
+void ht_delete(ht_table_t *table, char *key)
+{
+  if (table == NULL || table->ctrl == NULL) return;
+
+  size_t length = strlen(key);
+  int slot = ht_find(table, key, length, ht_hash(key, length));
+  if (slot < 0) return;
+
+  free(table->slots[slot].key);
+  table->count--;
+
+  signed char *group = &table->ctrl[slot - slot % HT_GROUP_SIZE];
+  if (ht_group_match(group, HT_CTRL_EMPTY) != 0)
+  {
+    table->ctrl[slot] = HT_CTRL_EMPTY;
+    table->growth_left++;
+  }
+  else
+  {
+    table->ctrl[slot] = HT_CTRL_DELETED;
+  }
+
+  if (table->size > table->min_size &&
+      table->count < table->min_load * table->size)
+  {
+    ht_resize(table, table->size / 2);
+  }
+}
+
+/*
+ * Zmazanie všetkých prvkov z tabuľky.
+ *
+ * Funkcia korektne uvoľní všetky alokované zdroje a uvedie tabuľku do stavu po
+ * inicializácii.
+ */
+void ht_delete_all(ht_table_t *table)
+{
+  if (table == NULL) return;
+
+  if (table->ctrl != NULL)
+  {
+    for (int i = 0; i < table->size; i++)
+    {
+      if (table->ctrl[i] >= 0)
+        free(table->slots[i].key);
+    }
+  }
+
+  free(table->ctrl);
+  free(table->slots);
+
+  table->ctrl = NULL;
+  table->slots = NULL;
+  table->size = table->min_size;
+  table->count = 0;
+  table->growth_left = 0;
+}
+
+/*
+ * Vyprázdnenie tabuľky bez uvoľnenia jej pamäte.
+ *
+ * The slot arrays keep their size. Keys are owned by the slots, so every full
+ * slot is still visited to free its key; the control bytes are reset with one
+ * memset.
+ */
+void ht_clear(ht_table_t *table)
+{
+  if (table == NULL || table->ctrl == NULL) return;
+
+  for (int i = 0; i < table->size; i++)
+  {
+    if (table->ctrl[i] >= 0)
+      free(table->slots[i].key);
+  }
+
+  memset(table->ctrl, HT_CTRL_EMPTY, table->size);
+  table->count = 0;
+  table->growth_left = (int)(table->size * table->max_load);
+}
+
+/*
+ * Štatistika tabuľky.
+ *
+ * A bucket is one group and its chain the items stored in it. Counters are
+ * copied only with -DHT_STATS, otherwise zero.
+ */
+void ht_stats(ht_table_t *table, ht_stats_t *stats)
+{
+  memset(stats, 0, sizeof(*stats));
+  if (table == NULL) return;
+
+  stats->buckets = table->size / HT_GROUP_SIZE;
+  for (int group = 0; group < stats->buckets; group++)
+  {
+    int length = 0;
+    for (int i = 0; table->ctrl != NULL && i < HT_GROUP_SIZE; i++)
+    {
+      if (table->ctrl[group * HT_GROUP_SIZE + i] >= 0)
+        length++;
+    }
+
+    stats->items += length;
+    if (length == 0)
+      stats->empty_buckets++;
+    if (length > stats->max_chain)
+      stats->max_chain = length;
+    stats->chains[length < HT_STATS_CHAINS ? length : HT_STATS_CHAINS - 1]++;
+  }
+
+  stats->load_factor = (float)stats->items / table->size;
+#ifdef HT_STATS
+  stats->counters = table->counters;
+#endif
+}
@@ -0,0 +1,111 @@
+/*
+ * Blokový Bloomov filter
+ *
+ * The size follows the usual Bloom filter estimate for HT_BLOOM_WORDS bits
+ * per key: with b bits per key the false positive rate is about
+ * (1 - e^(-k/b))^k for k = HT_BLOOM_WORDS. Keys are not spread evenly over
+ * the blocks, so the real rate is somewhat higher; ht_bloom_fpr measures it
+ * from the bits actually set.
+ */
+
+#include "ht_bloom.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Vytvorenie filtra pre capacity kľúčov.
+ *
+ * fpr is the wanted false positive rate at capacity keys. With max_bytes
+ * other than 0 the filter is never larger, even if the rate suffers. Returns
+ * NULL if memory runs out.
+ */
+ht_bloom_t *ht_bloom_new(int capacity, float fpr, size_t max_bytes)
+{
+  if (capacity < 1)
+    capacity = 1;
+  if (fpr <= 0.0f || fpr >= 1.0f)
+    fpr = 0.01f;
+
+  double bits_per_key = -HT_BLOOM_WORDS / log(1.0 - pow(fpr, 1.0 / HT_BLOOM_WORDS));
+  double blocks = ceil(capacity * bits_per_key / (HT_BLOOM_WORDS * 64));
+  if (max_bytes > 0 && blocks * HT_BLOOM_WORDS * sizeof(uint64_t) > max_bytes)
+    blocks = floor(max_bytes / (HT_BLOOM_WORDS * sizeof(uint64_t)));
+  if (blocks < 1)
+    blocks = 1;
+  if (blocks > UINT32_MAX)
+    blocks = UINT32_MAX;
+
+  ht_bloom_t *bloom = (ht_bloom_t*)malloc(sizeof(ht_bloom_t));
+  if (bloom == NULL) return NULL;
+
+  bloom->block_count = (uint32_t)blocks;
+  bloom->blocks = (uint64_t*)aligned_alloc(HT_BLOOM_WORDS * sizeof(uint64_t),
+                                           ht_bloom_bytes(bloom));
+  if (bloom->blocks == NULL)
+  {
+    free(bloom);
+    return NULL;
+  }
+
+  bloom->capacity = capacity;
+  bloom->fpr = fpr;
+  bloom->max_bytes = max_bytes;
+  ht_bloom_clear(bloom);
+  return bloom;
+}
+
+/*
+ * Uvoľnenie filtra.
+ */
+void ht_bloom_free(ht_bloom_t *bloom)
+{
+  if (bloom == NULL) return;
+
+  free(bloom->blocks);
+  free(bloom);
+}
+
+/*
+ * Vyprázdnenie filtra.
+ */
+void ht_bloom_clear(ht_bloom_t *bloom)
+{
+  if (bloom == NULL) return;
+
+  memset(bloom->blocks, 0, ht_bloom_bytes(bloom));
+  bloom->deleted = 0;
+}
+
+/*
+ * Veľkosť blokov filtra v bajtoch.
+ */
+size_t ht_bloom_bytes(const ht_bloom_t *bloom)
+{
+  if (bloom == NULL) return 0;
+  return (size_t)bloom->block_count * HT_BLOOM_WORDS * sizeof(uint64_t);
+}
+
+/*
+ * Odhad pravdepodobnosti falošnej zhody.
+ *
+ * A hash absent from the filter passes the test of its block if its bit is
+ * set in every word, so the rate for one block is the product of the
+ * fractions of set bits of its words. Averaged over all blocks (every block
+ * is equally likely).
+ */
+double ht_bloom_fpr(const ht_bloom_t *bloom)
+{
+  if (bloom == NULL) return 1.0;
+
+  double sum = 0.0;
+  for (uint32_t b = 0; b < bloom->block_count; b++)
+  {
+    const uint64_t *block = &bloom->blocks[(size_t)b * HT_BLOOM_WORDS];
+    double rate = 1.0;
+    for (int i = 0; i < HT_BLOOM_WORDS; i++)
+      rate *= __builtin_popcountll(block[i]) / 64.0;
+    sum += rate;
+  }
+  return sum / bloom->block_count;
+}
@@ -0,0 +1,71 @@
+/*
+ * Hlavičkový súbor pre blokový Bloomov filter.
+ *
+ * The filter answers whether a hash may belong to a key of the table. Every
+ * key sets one bit in each of the HT_BLOOM_WORDS words of a single block, a
+ * cache line chosen by the low bits of its hash; the bits come from the high
+ * bits multiplied by HT_BLOOM_WORDS odd constants. A lookup therefore reads
+ * one cache line and a "no" is always right.
+ *
+ * Bits are never cleared, so after deletes the filter only grows less
+ * selective until its owner builds it again.
+ */
+
+#ifndef IAL_HASHTABLE_HT_BLOOM_H
+#define IAL_HASHTABLE_HT_BLOOM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// 64-bit words of one block, a block is one cache line
+#define HT_BLOOM_WORDS 8
+
+// Blokový Bloomov filter
+typedef struct ht_bloom {
+  uint64_t *blocks;     // bloky po HT_BLOOM_WORDS slovách
+  uint32_t block_count; // počet blokov
+  int capacity;         // počet kľúčov, pre ktorý bol filter navrhnutý
+  int deleted;          // zmazané kľúče, ktorých bity ešte zostali nastavené
+  float fpr;            // požadovaná pravdepodobnosť falošnej zhody
+  size_t max_bytes;     // najväčšia veľkosť blokov, 0 bez obmedzenia
+} ht_bloom_t;
+
+static const uint32_t HT_BLOOM_SALT[HT_BLOOM_WORDS] = {
+    0x47b6137bu, 0x44974d91u, 0x8824ad5bu, 0xa2b7289du,
+    0x705495c7u, 0x2df1424bu, 0x9efc4947u, 0x5c6bfb31u};
+
+static inline const uint64_t *ht_bloom_block(const ht_bloom_t *bloom,
+                                             uint64_t hash)
+{
+  uint32_t block = (uint32_t)(((hash & 0xffffffffULL) * bloom->block_count) >> 32);
+  return &bloom->blocks[(size_t)block * HT_BLOOM_WORDS];
+}
+
+// Sets the bits of a key with the given hash
+static inline void ht_bloom_add(ht_bloom_t *bloom, uint64_t hash)
+{
+  uint64_t *block = (uint64_t*)ht_bloom_block(bloom, hash);
+  uint32_t x = (uint32_t)(hash >> 32);
+  for (int i = 0; i < HT_BLOOM_WORDS; i++)
+    block[i] |= 1ULL << ((x * HT_BLOOM_SALT[i]) >> 26);
+}
+
+// Returns false only if no key with the given hash was added
+static inline bool ht_bloom_contains(const ht_bloom_t *bloom, uint64_t hash)
+{
+  const uint64_t *block = ht_bloom_block(bloom, hash);
+  uint32_t x = (uint32_t)(hash >> 32);
+  uint64_t found = 1;
+  for (int i = 0; i < HT_BLOOM_WORDS; i++)
+    found &= block[i] >> ((x * HT_BLOOM_SALT[i]) >> 26);
+  return (found & 1) != 0;
+}
+
+ht_bloom_t *ht_bloom_new(int capacity, float fpr, size_t max_bytes);
+void ht_bloom_free(ht_bloom_t *bloom);
+void ht_bloom_clear(ht_bloom_t *bloom);
+size_t ht_bloom_bytes(const ht_bloom_t *bloom);
+double ht_bloom_fpr(const ht_bloom_t *bloom);
+
+#endif
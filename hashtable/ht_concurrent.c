@@ -0,0 +1,363 @@
+/*
+ * Tabuľka s rozptýlenými položkami zdieľaná medzi vláknami
+ *
+ * Buckets are split into HTC_STRIPES stripes, a writer locks the stripe of
+ * the key's bucket. Readers take no lock: every pointer a writer publishes is
+ * stored with release semantics after the item is fully built, so a reader
+ * loading it with acquire semantics always sees a complete item.
+ *
+ * A deleted item may still be in use by readers that reached it before it was
+ * unlinked. It is therefore retired into the limbo list of the current epoch
+ * of the deleting handle. The global epoch only advances once every handle in
+ * a critical section has seen the current one, so items retired in epoch e
+ * can be freed as soon as the global epoch reaches e + 2.
+ */
+
+#include "ht_concurrent.h"
+#include "ht_hash.h"
+#include <stdlib.h>
+#include <string.h>
+
+static inline bool htc_item_matches(htc_item_t *item, const char *key,
+                                    size_t length, uint64_t hash)
+{
+  return item->hash == hash && item->length == length &&
+         memcmp(item->key, key, length) == 0;
+}
+
+static inline pthread_mutex_t *htc_lock(htc_table_t *table, int index)
+{
+  return &table->locks[index % HTC_STRIPES];
+}
+
+/*
+ * Vytvorenie prázdnej tabuľky s daným počtom zoznamov synoným.
+ */
+bool htc_init(htc_table_t *table, int size)
+{
+  if (table == NULL || size < 1) return false;
+
+  table->buckets = (_Atomic(htc_item_t*)*)malloc(size * sizeof(*table->buckets));
+  if (table->buckets == NULL) return false;
+
+  for (int i = 0; i < size; i++)
+  {
+    atomic_init(&table->buckets[i], NULL);
+  }
+  for (int i = 0; i < HTC_STRIPES; i++)
+  {
+    pthread_mutex_init(&table->locks[i], NULL);
+  }
+
+  table->size = size;
+  atomic_init(&table->count, 0);
+  atomic_init(&table->epoch, 0);
+  atomic_init(&table->handles, NULL);
+  return true;
+}
+
+static void htc_free_retired(htc_item_t *item)
+{
+  while (item != NULL)
+  {
+    htc_item_t *next = item->retired;
+    free(item);
+    item = next;
+  }
+}
+
+/*
+ * Zrušenie tabuľky.
+ *
+ * No other thread may use the table or any of its handles any more.
+ */
+void htc_destroy(htc_table_t *table)
+{
+  if (table == NULL || table->buckets == NULL) return;
+
+  for (int i = 0; i < table->size; i++)
+  {
+    htc_item_t *item = atomic_load(&table->buckets[i]);
+    while (item != NULL)
+    {
+      htc_item_t *next = atomic_load(&item->next);
+      free(item);
+      item = next;
+    }
+  }
+
+  htc_handle_t *handle = atomic_load(&table->handles);
+  while (handle != NULL)
+  {
+    htc_handle_t *next = handle->next;
+    for (int i = 0; i < 3; i++)
+    {
+      htc_free_retired(handle->limbo[i]);
+    }
+    free(handle);
+    handle = next;
+  }
+
+  for (int i = 0; i < HTC_STRIPES; i++)
+  {
+    pthread_mutex_destroy(&table->locks[i]);
+  }
+
+  free(table->buckets);
+  table->buckets = NULL;
+  table->size = 0;
+  atomic_store(&table->count, 0);
+  atomic_store(&table->handles, NULL);
+}
+
+/*
+ * Pripojenie vlákna k tabuľke.
+ *
+ * Reuses a detached handle if there is one. Returns NULL when a new handle
+ * could not be allocated.
+ */
+htc_handle_t *htc_attach(htc_table_t *table)
+{
+  for (htc_handle_t *handle = atomic_load(&table->handles); handle != NULL;
+       handle = handle->next)
+  {
+    bool expected = false;
+    if (atomic_compare_exchange_strong(&handle->in_use, &expected, true))
+      return handle;
+  }
+
+  htc_handle_t *handle = (htc_handle_t*)malloc(sizeof(htc_handle_t));
+  if (handle == NULL) return NULL;
+
+  handle->table = table;
+  atomic_init(&handle->in_use, true);
+  atomic_init(&handle->active, false);
+  atomic_init(&handle->epoch, 0);
+  for (int i = 0; i < 3; i++)
+  {
+    handle->limbo[i] = NULL;
+    handle->limbo_epoch[i] = 0;
+  }
+  handle->retired_count = 0;
+
+  // Handles are never unlinked before htc_destroy, so a plain push is enough
+  handle->next = atomic_load(&table->handles);
+  while (!atomic_compare_exchange_weak(&table->handles, &handle->next, handle))
+    ;
+
+  return handle;
+}
+
+/*
+ * Odpojenie vlákna od tabuľky.
+ *
+ * Items the handle retired stay in its limbo lists until the handle is reused
+ * or the table destroyed.
+ */
+void htc_detach(htc_handle_t *handle)
+{
+  if (handle == NULL) return;
+
+  atomic_store(&handle->active, false);
+  atomic_store(&handle->in_use, false);
+}
+
+static inline void htc_enter(htc_handle_t *handle)
+{
+  atomic_store(&handle->epoch, atomic_load(&handle->table->epoch));
+  atomic_store(&handle->active, true);
+
+  // The announcement must be visible before any chain pointer is read
+  atomic_thread_fence(memory_order_seq_cst);
+}
+
+static inline void htc_leave(htc_handle_t *handle)
+{
+  atomic_store_explicit(&handle->active, false, memory_order_release);
+}
+
+/*
+ * Advances the global epoch if every handle inside a critical section has
+ * already observed the current one.
+ */
+static void htc_try_advance(htc_table_t *table)
+{
+  unsigned epoch = atomic_load(&table->epoch);
+
+  for (htc_handle_t *handle = atomic_load(&table->handles); handle != NULL;
+       handle = handle->next)
+  {
+    if (atomic_load(&handle->active) && atomic_load(&handle->epoch) != epoch)
+      return;
+  }
+
+  atomic_compare_exchange_strong(&table->epoch, &epoch, epoch + 1);
+}
+
+/*
+ * Frees the limbo lists retired at least two epochs before epoch.
+ */
+static void htc_reclaim(htc_handle_t *handle, unsigned epoch)
+{
+  for (int i = 0; i < 3; i++)
+  {
+    if (handle->limbo[i] != NULL && epoch - handle->limbo_epoch[i] >= 2)
+    {
+      htc_item_t *item = handle->limbo[i];
+      while (item != NULL)
+      {
+        htc_item_t *next = item->retired;
+        free(item);
+        handle->retired_count--;
+        item = next;
+      }
+      handle->limbo[i] = NULL;
+    }
+  }
+}
+
+static void htc_retire(htc_handle_t *handle, htc_item_t *item)
+{
+  htc_table_t *table = handle->table;
+  unsigned epoch = atomic_load(&table->epoch);
+
+  htc_reclaim(handle, epoch);
+
+  int index = epoch % 3;
+  item->retired = handle->limbo[index];
+  handle->limbo[index] = item;
+  handle->limbo_epoch[index] = epoch;
+  handle->retired_count++;
+
+  if (handle->retired_count >= HTC_RETIRE_THRESHOLD)
+  {
+    htc_try_advance(table);
+    htc_reclaim(handle, atomic_load(&table->epoch));
+  }
+}
+
+/*
+ * Získanie hodnoty z tabuľky bez zamykania.
+ *
+ * Returns true and stores the value of key to value if the key is present.
+ */
+bool htc_get(htc_handle_t *handle, const char *key, float *value)
+{
+  htc_table_t *table = handle->table;
+  size_t length = strlen(key);
+  uint64_t hash = ht_hash(key, length);
+  bool found = false;
+
+  htc_enter(handle);
+
+  htc_item_t *item = atomic_load_explicit(
+      &table->buckets[ht_hash_index(hash, table->size)], memory_order_acquire);
+  while (item != NULL)
+  {
+    if (htc_item_matches(item, key, length, hash))
+    {
+      *value = atomic_load_explicit(&item->value, memory_order_relaxed);
+      found = true;
+      break;
+    }
+
+    item = atomic_load_explicit(&item->next, memory_order_acquire);
+  }
+
+  htc_leave(handle);
+  return found;
+}
+
+/*
+ * Vloženie prvku do tabuľky.
+ *
+ * Pokiaľ prvok s daným kľúčom už v tabuľke existuje, nahradí sa jeho hodnota.
+ * Returns false if a new item could not be allocated.
+ */
+bool htc_insert(htc_handle_t *handle, const char *key, float value)
+{
+  htc_table_t *table = handle->table;
+  size_t length = strlen(key);
+  uint64_t hash = ht_hash(key, length);
+  int index = ht_hash_index(hash, table->size);
+
+  pthread_mutex_t *lock = htc_lock(table, index);
+  pthread_mutex_lock(lock);
+
+  // Only writers holding this lock change the chain, relaxed loads suffice
+  htc_item_t *head = atomic_load_explicit(&table->buckets[index],
+                                          memory_order_relaxed);
+  for (htc_item_t *item = head; item != NULL;
+       item = atomic_load_explicit(&item->next, memory_order_relaxed))
+  {
+    if (htc_item_matches(item, key, length, hash))
+    {
+      atomic_store_explicit(&item->value, value, memory_order_relaxed);
+      pthread_mutex_unlock(lock);
+      return true;
+    }
+  }
+
+  htc_item_t *item = (htc_item_t*)malloc(sizeof(htc_item_t) + length + 1);
+  if (item == NULL)
+  {
+    pthread_mutex_unlock(lock);
+    return false;
+  }
+
+  memcpy(item->key, key, length + 1);
+  item->hash = hash;
+  item->length = (unsigned)length;
+  item->retired = NULL;
+  atomic_init(&item->value, value);
+  atomic_init(&item->next, head);
+
+  // Publish the complete item
+  atomic_store_explicit(&table->buckets[index], item, memory_order_release);
+  atomic_fetch_add(&table->count, 1);
+
+  pthread_mutex_unlock(lock);
+  return true;
+}
+
+/*
+ * Zmazanie prvku z tabuľky.
+ *
+ * The item is unlinked under the stripe lock and retired; its memory is
+ * freed once no reader can reach it. Returns true if the key was present.
+ */
+bool htc_delete(htc_handle_t *handle, const char *key)
+{
+  htc_table_t *table = handle->table;
+  size_t length = strlen(key);
+  uint64_t hash = ht_hash(key, length);
+  int index = ht_hash_index(hash, table->size);
+
+  pthread_mutex_t *lock = htc_lock(table, index);
+  pthread_mutex_lock(lock);
+
+  _Atomic(htc_item_t*) *link = &table->buckets[index];
+  htc_item_t *item = atomic_load_explicit(link, memory_order_relaxed);
+  while (item != NULL)
+  {
+    if (htc_item_matches(item, key, length, hash))
+    {
+      // Readers standing on item can still follow its next pointer
+      atomic_store_explicit(
+          link, atomic_load_explicit(&item->next, memory_order_relaxed),
+          memory_order_release);
+      atomic_fetch_sub(&table->count, 1);
+      break;
+    }
+
+    link = &item->next;
+    item = atomic_load_explicit(link, memory_order_relaxed);
+  }
+
+  pthread_mutex_unlock(lock);
+
+  if (item == NULL) return false;
+
+  htc_retire(handle, item);
+  return true;
+}
@@ -0,0 +1,68 @@
+/*
+ * Hlavičkový súbor pre tabuľku zdieľanú medzi vláknami.
+ *
+ * Writers lock one stripe of buckets, readers walk the chains without any
+ * lock. Deleted items are retired with epoch based reclamation and freed only
+ * once no reader can still be looking at them.
+ *
+ * Every thread works with the table through its own handle obtained from
+ * htc_attach. The number of buckets is fixed at htc_init.
+ */
+
+#ifndef IAL_HASHTABLE_HT_CONCURRENT_H
+#define IAL_HASHTABLE_HT_CONCURRENT_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Number of bucket stripes, each guarded by one writer lock
+#define HTC_STRIPES 64
+
+// Retired items a handle collects before it tries to advance the epoch
+#define HTC_RETIRE_THRESHOLD 64
+
+// Prvok zdieľanej tabuľky
+typedef struct htc_item {
+  _Atomic(struct htc_item *) next; // ďalšie synonymum
+  struct htc_item *retired;        // ďalší prvok v zozname na uvoľnenie
+  uint64_t hash;                   // rozptylová hodnota kľúča
+  unsigned length;                 // dĺžka kľúča
+  _Atomic float value;             // hodnota prvku
+  char key[];                      // kľúč prvku
+} htc_item_t;
+
+// Prístup jedného vlákna k tabuľke
+typedef struct htc_handle {
+  struct htc_table *table;       // tabuľka ku ktorej patrí
+  struct htc_handle *next;       // ďalší handle tabuľky
+  atomic_bool in_use;            // handle patrí nejakému vláknu
+  atomic_bool active;            // vlákno je v kritickej sekcii
+  atomic_uint epoch;             // epocha pozorovaná pri vstupe
+  htc_item_t *limbo[3];          // vyradené prvky podľa epochy
+  unsigned limbo_epoch[3];       // epocha vyradenia prvkov v limbo
+  int retired_count;             // počet vyradených, ešte neuvoľnených
+} htc_handle_t;
+
+// Tabuľka zdieľaná medzi vláknami
+typedef struct htc_table {
+  _Atomic(htc_item_t *) *buckets;     // pole zoznamov synoným
+  int size;                           // počet zoznamov
+  atomic_int count;                   // počet položiek
+  atomic_uint epoch;                  // globálna epocha
+  _Atomic(htc_handle_t *) handles;    // všetky handle tabuľky
+  pthread_mutex_t locks[HTC_STRIPES]; // zámky pre zapisovateľov
+} htc_table_t;
+
+bool htc_init(htc_table_t *table, int size);
+void htc_destroy(htc_table_t *table);
+
+htc_handle_t *htc_attach(htc_table_t *table);
+void htc_detach(htc_handle_t *handle);
+
+bool htc_get(htc_handle_t *handle, const char *key, float *value);
+bool htc_insert(htc_handle_t *handle, const char *key, float value);
+bool htc_delete(htc_handle_t *handle, const char *key);
+
+#endif
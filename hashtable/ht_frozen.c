@@ -0,0 +1,278 @@
+/*
+ * Zmrazená tabuľka s minimálnou dokonalou rozptyľovacou funkciou
+ *
+ * A key with hash h belongs to bucket ht_hash_index(h, bucket_count) and is
+ * stored in entry ht_hash_index(ht_hash_int(h + seed), count), where seed is
+ * the value kept for its bucket. ht_freeze places the buckets from the
+ * largest down and tries seeds 0, 1, ... until all keys of a bucket land in
+ * distinct free entries. Buckets with a single key are placed last and
+ * simply take the next free entry, its index is stored with the
+ * HT_FROZEN_DIRECT flag instead of a seed.
+ */
+
+#include "ht_frozen.h"
+#include "ht_generic.h"
+#include "ht_hash.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Item of the source table with its hash copied next to it, so building
+// does not have to go back to the scattered items
+typedef struct ht_source {
+  uint64_t hash;   // rozptylová hodnota kľúča
+  ht_item_t *item; // prvok zdrojovej tabuľky
+} ht_source_t;
+
+// Items of the source table gathered through ht_scan
+typedef struct ht_gather {
+  ht_source_t *items; // nájdené prvky
+  int count;          // počet nájdených prvkov
+  int capacity;       // veľkosť poľa items
+} ht_gather_t;
+
+static void ht_gather(ht_item_t *item, void *data)
+{
+  ht_gather_t *gather = (ht_gather_t*)data;
+  if (gather->count < gather->capacity)
+  {
+    gather->items[gather->count].hash = item->hash;
+    gather->items[gather->count++].item = item;
+  }
+}
+
+// Entry of a key with the given hash in a bucket with the given seed
+static inline int ht_frozen_slot(uint64_t hash, uint32_t seed, int count)
+{
+  return ht_hash_index(ht_hash_int(hash + seed), count);
+}
+
+/*
+ * Finds the seed placing all items of a bucket into distinct entries that
+ * are not taken yet, marks them taken and stores them into slots. Returns
+ * false if no seed below HT_FROZEN_MAX_SEED works (two keys with the same
+ * hash).
+ */
+static bool ht_frozen_place(ht_source_t *items, int size, int count,
+                            bool *taken, int *slots, uint32_t *seed)
+{
+  for (uint32_t s = 0; s < HT_FROZEN_MAX_SEED; s++)
+  {
+    int placed = 0;
+    while (placed < size)
+    {
+      int slot = ht_frozen_slot(items[placed].hash, s, count);
+      if (taken[slot]) break;
+      taken[slot] = true;
+      slots[placed++] = slot;
+    }
+
+    if (placed == size)
+    {
+      *seed = s;
+      return true;
+    }
+
+    while (placed-- > 0)
+      taken[slots[placed]] = false;
+  }
+
+  return false;
+}
+
+/*
+ * Copies item into entry slot, a long key to the end of the key array.
+ */
+static void ht_frozen_fill(ht_frozen_t *frozen, int slot, ht_item_t *item,
+                           size_t *keys_end)
+{
+  ht_frozen_entry_t *entry = &frozen->entries[slot];
+  entry->hash = item->hash;
+  entry->value = item->value;
+  entry->length = item->length;
+
+  if (item->length <= HT_FROZEN_INLINE)
+  {
+    memcpy(entry->key.bytes, item->key, item->length);
+  }
+  else
+  {
+    entry->key.offset = *keys_end;
+    memcpy(frozen->keys + *keys_end, item->key, item->length);
+    *keys_end += item->length;
+  }
+}
+
+/*
+ * Zmrazenie tabuľky.
+ *
+ * Works with every engine, items are read through ht_scan. Returns NULL if
+ * memory runs out or the keys cannot be told apart by their hashes.
+ */
+ht_frozen_t *ht_freeze(ht_table_t *table)
+{
+  if (table == NULL) return NULL;
+
+  int capacity = table->count > 0 ? table->count : 0;
+  ht_gather_t gather = {(ht_source_t*)malloc((capacity + 1) * sizeof(ht_source_t)), 0, capacity};
+  ht_frozen_t *frozen = (ht_frozen_t*)calloc(1, sizeof(ht_frozen_t));
+  if (gather.items == NULL || frozen == NULL)
+  {
+    free(gather.items);
+    free(frozen);
+    return NULL;
+  }
+
+  uint64_t cursor = 0;
+  do
+  {
+    cursor = ht_scan(table, cursor, ht_gather, &gather, capacity + 1);
+  } while (cursor != 0);
+
+  int count = gather.count;
+  int buckets = count / HT_FROZEN_BUCKET_SIZE + 1;
+  size_t keys_size = 1;
+  for (int i = 0; i < count; i++)
+  {
+    if (gather.items[i].item->length > HT_FROZEN_INLINE)
+      keys_size += gather.items[i].item->length;
+  }
+
+  frozen->seeds = (uint32_t*)calloc(buckets, sizeof(uint32_t));
+  frozen->bucket_count = buckets;
+  frozen->entries = (ht_frozen_entry_t*)malloc((count + 1) * sizeof(ht_frozen_entry_t));
+  frozen->count = count;
+  frozen->keys = (char*)malloc(keys_size);
+
+  // Items ordered by bucket, bucket b holds sorted[first[b]..first[b + 1])
+  int *first = (int*)calloc(buckets + 1, sizeof(int));
+  ht_source_t *sorted = (ht_source_t*)malloc((count + 1) * sizeof(ht_source_t));
+  int *order = (int*)malloc(buckets * sizeof(int));
+  bool *taken = (bool*)calloc(count + 1, sizeof(bool));
+  int *slots = (int*)malloc((count + 1) * sizeof(int));
+
+  bool ok = frozen->seeds != NULL && frozen->entries != NULL &&
+            frozen->keys != NULL && first != NULL && sorted != NULL &&
+            order != NULL && taken != NULL && slots != NULL;
+
+  if (ok)
+  {
+    for (int i = 0; i < count; i++)
+      first[ht_hash_index(gather.items[i].hash, buckets) + 1]++;
+
+    // Buckets by decreasing size, counted before first turns into offsets
+    int max_size = 0;
+    for (int b = 0; b < buckets; b++)
+    {
+      if (first[b + 1] > max_size)
+        max_size = first[b + 1];
+    }
+    int placed = 0;
+    for (int size = max_size; size > 0; size--)
+    {
+      for (int b = 0; b < buckets; b++)
+      {
+        if (first[b + 1] == size)
+          order[placed++] = b;
+      }
+    }
+
+    for (int b = 0; b < buckets; b++)
+      first[b + 1] += first[b];
+    for (int i = 0; i < count; i++)
+    {
+      int b = ht_hash_index(gather.items[i].hash, buckets);
+      sorted[first[b]++] = gather.items[i];
+    }
+    // After the sort first[b] is the end of bucket b
+    for (int b = buckets; b > 0; b--)
+      first[b] = first[b - 1];
+    first[0] = 0;
+
+    size_t keys_end = 0;
+    int next_free = 0;
+    for (int i = 0; ok && i < placed; i++)
+    {
+      int b = order[i];
+      int size = first[b + 1] - first[b];
+      ht_source_t *items = &sorted[first[b]];
+
+      if (size == 1)
+      {
+        while (taken[next_free])
+          next_free++;
+        taken[next_free] = true;
+        slots[0] = next_free;
+        frozen->seeds[b] = HT_FROZEN_DIRECT | (uint32_t)next_free;
+      }
+      else
+      {
+        ok = ht_frozen_place(items, size, count, taken, slots, &frozen->seeds[b]);
+      }
+
+      for (int j = 0; ok && j < size; j++)
+        ht_frozen_fill(frozen, slots[j], items[j].item, &keys_end);
+    }
+  }
+
+  free(gather.items);
+  free(first);
+  free(sorted);
+  free(order);
+  free(taken);
+  free(slots);
+
+  if (!ok)
+  {
+    ht_frozen_free(frozen);
+    return NULL;
+  }
+  return frozen;
+}
+
+/*
+ * Uvoľnenie zmrazenej tabuľky.
+ */
+void ht_frozen_free(ht_frozen_t *frozen)
+{
+  if (frozen == NULL) return;
+
+  free(frozen->seeds);
+  free(frozen->entries);
+  free(frozen->keys);
+  free(frozen);
+}
+
+/*
+ * Vyhľadanie prvku v zmrazenej tabuľke.
+ *
+ * The key is compared with the one entry its hash leads to.
+ */
+const ht_frozen_entry_t *ht_frozen_search(const ht_frozen_t *frozen,
+                                          const char *key)
+{
+  if (frozen == NULL || key == NULL || frozen->count == 0) return NULL;
+
+  size_t length = strlen(key);
+  uint64_t hash = ht_hash(key, length);
+  uint32_t seed = frozen->seeds[ht_hash_index(hash, frozen->bucket_count)];
+  int slot = seed & HT_FROZEN_DIRECT ? (int)(seed & ~HT_FROZEN_DIRECT)
+                                     : ht_frozen_slot(hash, seed, frozen->count);
+
+  const ht_frozen_entry_t *entry = &frozen->entries[slot];
+  if (entry->hash != hash || entry->length != length) return NULL;
+
+  const char *stored = length <= HT_FROZEN_INLINE ? entry->key.bytes
+                                                  : frozen->keys + entry->key.offset;
+  if (memcmp(stored, key, length) == 0)
+    return entry;
+  return NULL;
+}
+
+/*
+ * Získanie hodnoty zo zmrazenej tabuľky.
+ */
+const float *ht_frozen_get(const ht_frozen_t *frozen, const char *key)
+{
+  const ht_frozen_entry_t *entry = ht_frozen_search(frozen, key);
+  return entry != NULL ? &entry->value : NULL;
+}
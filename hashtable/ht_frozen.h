@@ -0,0 +1,61 @@
+/*
+ * Hlavičkový súbor pre zmrazenú tabuľku len na čítanie.
+ *
+ * ht_freeze copies the items of a table into a compact structure indexed by
+ * a minimal perfect hash function (hash and displace, as in CHD): keys are
+ * split into small buckets and every bucket stores the seed that maps its
+ * keys to distinct entries. A lookup hashes the key, reads the seed of its
+ * bucket and compares the key with exactly one entry. Entries are stored in
+ * one contiguous array, without pointers between items; keys of up to
+ * HT_FROZEN_INLINE bytes are kept in the entry itself, so a typical hit
+ * reads the seed and a single entry. Longer keys share one key array.
+ *
+ * The frozen table does not change when the source table does.
+ */
+
+#ifndef IAL_HASHTABLE_HT_FROZEN_H
+#define IAL_HASHTABLE_HT_FROZEN_H
+
+#include "hashtable.h"
+#include <stdint.h>
+
+// Average number of keys per bucket of the perfect hash function
+#define HT_FROZEN_BUCKET_SIZE 4
+
+// Seeds tried for one bucket before ht_freeze gives up
+#define HT_FROZEN_MAX_SEED (1u << 20)
+
+// Longest key stored inside its entry
+#define HT_FROZEN_INLINE 16
+
+// Seed flag of a bucket with one key stored directly in entry seed & ~flag
+#define HT_FROZEN_DIRECT 0x80000000u
+
+// Položka zmrazenej tabuľky
+typedef struct ht_frozen_entry {
+  uint64_t hash;   // rozptylová hodnota kľúča
+  float value;     // hodnota prvku
+  uint32_t length; // dĺžka kľúča
+  union {
+    char bytes[HT_FROZEN_INLINE]; // kľúč do HT_FROZEN_INLINE bajtov
+    uint64_t offset;              // offset dlhšieho kľúča v poli keys
+  } key;
+} ht_frozen_entry_t;
+
+// Zmrazená tabuľka
+typedef struct ht_frozen {
+  uint32_t *seeds;            // posun každého zoznamu (HT_FROZEN_DIRECT)
+  int bucket_count;           // počet zoznamov
+  ht_frozen_entry_t *entries; // položky, jedna pre každý kľúč
+  int count;                  // počet položiek
+  char *keys;                 // dlhé kľúče za sebou
+} ht_frozen_t;
+
+ht_frozen_t *ht_freeze(ht_table_t *table);
+void ht_frozen_free(ht_frozen_t *frozen);
+
+const ht_frozen_entry_t *ht_frozen_search(const ht_frozen_t *frozen,
+                                          const char *key);
+const float *ht_frozen_get(const ht_frozen_t *frozen, const char *key);
+
+#endif
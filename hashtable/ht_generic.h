@@ -0,0 +1,188 @@
+/*
+ * Hlavičkový súbor pre typové tabuľky generované makrom.
+ *
+ * HTDEC declares and HTDEF defines a table specialised for one key and value
+ * type, the same way STACKDEC and STACKDEF generate the stacks in
+ * btree/iter/stack.h. Keys and values are stored inline in one array and the
+ * hash and equality functions are called directly, so they can be inlined.
+ *
+ * The table uses open addressing with linear probing and backward shift
+ * deletion (no tombstones). Its capacity is a power of two that doubles when
+ * more than HTG_MAX_LOAD_PERCENT percent of slots are used.
+ */
+
+#ifndef IAL_HASHTABLE_HT_GENERIC_H
+#define IAL_HASHTABLE_HT_GENERIC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// Capacity of a table after its first insert
+#define HTG_MIN_CAPACITY 16
+
+// Grow when items exceed this percentage of the capacity
+#define HTG_MAX_LOAD_PERCENT 75
+
+// Hash for integer keys (the fmix64 finalizer)
+static inline uint64_t ht_hash_int(uint64_t key)
+{
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccdULL;
+  key ^= key >> 33;
+  key *= 0xc4ceb9fe1a85ec53ULL;
+  key ^= key >> 33;
+  return key;
+}
+
+// Equality of keys comparable with ==
+#define HT_EQ(A, B) ((A) == (B))
+
+/*
+ * Makro generujúce deklarácie pre tabuľku s kľúčmi typu K a hodnotami typu V
+ * s názvovým infixom NAME. HASHFN(K) vracia uint64_t, EQFN(K, K) porovnáva
+ * kľúče. Pre NAME="int":
+ *   Dátový typ ht_int_t
+ *   Funkcie void ht_int_init(ht_int_t *table)
+ *           bool ht_int_insert(ht_int_t *table, K key, V value)
+ *           V *ht_int_get(ht_int_t *table, K key)
+ *           void ht_int_delete(ht_int_t *table, K key)
+ *           void ht_int_delete_all(ht_int_t *table)
+ */
+#define HTDEC(K, V, NAME, HASHFN, EQFN)                                        \
+  typedef struct {                                                             \
+    K key;                                                                     \
+    V value;                                                                   \
+  } ht_##NAME##_entry_t;                                                       \
+                                                                               \
+  typedef struct {                                                             \
+    ht_##NAME##_entry_t *entries;                                              \
+    bool *used;                                                                \
+    int capacity;                                                              \
+    int count;                                                                 \
+  } ht_##NAME##_t;                                                             \
+                                                                               \
+  void ht_##NAME##_init(ht_##NAME##_t *table);                                 \
+  bool ht_##NAME##_insert(ht_##NAME##_t *table, K key, V value);               \
+  V *ht_##NAME##_get(ht_##NAME##_t *table, K key);                             \
+  void ht_##NAME##_delete(ht_##NAME##_t *table, K key);                        \
+  void ht_##NAME##_delete_all(ht_##NAME##_t *table);
+
+/*
+ * Makro generujúce implementáciu funkcií tabuľky, parametre ako pri HTDEC.
+ * The home slot comes from the high 32 bits of the hash (multiply-shift, see
+ * ht_hash_index).
+ */
+#define HTDEF(K, V, NAME, HASHFN, EQFN)                                        \
+  static inline int ht_##NAME##_home(ht_##NAME##_t *table, K key) {            \
+    return (int)(((HASHFN(key) >> 32) * (uint64_t)table->capacity) >> 32);    \
+  }                                                                            \
+                                                                               \
+  /* Slot holding key, or the empty slot where it would go */                  \
+  static inline int ht_##NAME##_probe(ht_##NAME##_t *table, K key) {          \
+    int slot = ht_##NAME##_home(table, key);                                   \
+    while (table->used[slot] && !EQFN(table->entries[slot].key, key)) {        \
+      if (++slot == table->capacity) {                                         \
+        slot = 0;                                                              \
+      }                                                                        \
+    }                                                                          \
+    return slot;                                                               \
+  }                                                                            \
+                                                                               \
+  static bool ht_##NAME##_resize(ht_##NAME##_t *table, int capacity) {         \
+    ht_##NAME##_t grown = {NULL, NULL, capacity, table->count};                \
+    grown.entries = (ht_##NAME##_entry_t *)malloc(                             \
+        capacity * sizeof(ht_##NAME##_entry_t));                               \
+    grown.used = (bool *)calloc(capacity, sizeof(bool));                       \
+    if (grown.entries == NULL || grown.used == NULL) {                         \
+      free(grown.entries);                                                     \
+      free(grown.used);                                                        \
+      return false;                                                            \
+    }                                                                          \
+                                                                               \
+    for (int i = 0; i < table->capacity; i++) {                                \
+      if (table->used[i]) {                                                    \
+        int slot = ht_##NAME##_probe(&grown, table->entries[i].key);           \
+        grown.entries[slot] = table->entries[i];                               \
+        grown.used[slot] = true;                                               \
+      }                                                                        \
+    }                                                                          \
+                                                                               \
+    free(table->entries);                                                      \
+    free(table->used);                                                         \
+    *table = grown;                                                            \
+    return true;                                                               \
+  }                                                                            \
+                                                                               \
+  void ht_##NAME##_init(ht_##NAME##_t *table) {                                \
+    table->entries = NULL;                                                     \
+    table->used = NULL;                                                        \
+    table->capacity = 0;                                                       \
+    table->count = 0;                                                          \
+  }                                                                            \
+                                                                               \
+  bool ht_##NAME##_insert(ht_##NAME##_t *table, K key, V value) {              \
+    if ((table->count + 1) * 100 > table->capacity * HTG_MAX_LOAD_PERCENT &&   \
+        !ht_##NAME##_resize(table, table->capacity == 0                        \
+                                       ? HTG_MIN_CAPACITY                      \
+                                       : table->capacity * 2)) {               \
+      return false;                                                            \
+    }                                                                          \
+                                                                               \
+    int slot = ht_##NAME##_probe(table, key);                                  \
+    if (!table->used[slot]) {                                                  \
+      table->entries[slot].key = key;                                          \
+      table->used[slot] = true;                                                \
+      table->count++;                                                          \
+    }                                                                          \
+    table->entries[slot].value = value;                                        \
+    return true;                                                               \
+  }                                                                            \
+                                                                               \
+  V *ht_##NAME##_get(ht_##NAME##_t *table, K key) {                            \
+    if (table->count == 0) {                                                   \
+      return NULL;                                                             \
+    }                                                                          \
+    int slot = ht_##NAME##_probe(table, key);                                  \
+    return table->used[slot] ? &table->entries[slot].value : NULL;             \
+  }                                                                            \
+                                                                               \
+  /* Later entries of the run move back into the hole unless that would put */ \
+  /* them before their home slot */                                            \
+  void ht_##NAME##_delete(ht_##NAME##_t *table, K key) {                       \
+    if (table->count == 0) {                                                   \
+      return;                                                                  \
+    }                                                                          \
+    int hole = ht_##NAME##_probe(table, key);                                  \
+    if (!table->used[hole]) {                                                  \
+      return;                                                                  \
+    }                                                                          \
+                                                                               \
+    int slot = hole;                                                           \
+    for (;;) {                                                                 \
+      if (++slot == table->capacity) {                                         \
+        slot = 0;                                                              \
+      }                                                                        \
+      if (!table->used[slot]) {                                                \
+        break;                                                                 \
+      }                                                                        \
+      int home = ht_##NAME##_home(table, table->entries[slot].key);            \
+      bool movable = hole <= slot ? (home <= hole || home > slot)              \
+                                  : (home <= hole && home > slot);             \
+      if (movable) {                                                           \
+        table->entries[hole] = table->entries[slot];                           \
+        hole = slot;                                                           \
+      }                                                                        \
+    }                                                                          \
+                                                                               \
+    table->used[hole] = false;                                                 \
+    table->count--;                                                            \
+  }                                                                            \
+                                                                               \
+  void ht_##NAME##_delete_all(ht_##NAME##_t *table) {                          \
+    free(table->entries);                                                      \
+    free(table->used);                                                         \
+    ht_##NAME##_init(table);                                                   \
+  }
+
+#endif
@@ -0,0 +1,413 @@
+/*
+ * Rozptyľovacie funkcie tabuľky s rozptýlenými položkami.
+ *
+ * Every variant mixes the key length into its starting state, works on
+ * unsigned bytes and finishes with a 64-bit avalanche, so anagrams and keys
+ * differing only in length end up in unrelated buckets.
+ */
+
+#include "ht_hash.h"
+#include <stdbool.h>
+#include <string.h>
+
+// The vector kernel of ht_hash_many covers the short hash on x86-64. It is
+// built only with -DHT_HASH_AVX2, it does not hash faster than ht_hash on
+// every CPU (compare with make bench AVX2=1)
+#if defined(HT_HASH_AVX2) && \
+    !(defined(__x86_64__) && defined(__GNUC__) && \
+      (HT_HASH == HT_HASH_SHORT || HT_HASH == HT_HASH_ADAPTIVE))
+#undef HT_HASH_AVX2
+#endif
+
+#ifdef HT_HASH_AVX2
+#include <immintrin.h>
+
+// Keys hashed together by the vector kernel, four per register
+#define HT_HASH_LANES 16
+#endif
+
+#define HT_SEED 0x9e3779b97f4a7c15ULL
+
+#define PRIME_1 0x9e3779b185ebca87ULL
+#define PRIME_2 0xc2b2ae3d27d4eb4fULL
+#define PRIME_3 0x165667b19e3779f9ULL
+#define PRIME_4 0x85ebca77c2b2ae63ULL
+#define PRIME_5 0x27d4eb2f165667c5ULL
+
+static inline uint64_t rotl64(uint64_t x, int r)
+{
+  return (x << r) | (x >> (64 - r));
+}
+
+/*
+ * Final avalanche so that every input bit affects the high bits used by
+ * ht_hash_index.
+ */
+static inline uint64_t fmix64(uint64_t h)
+{
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+static inline uint64_t wide_round(uint64_t h, uint64_t word)
+{
+  word *= PRIME_2;
+  word = rotl64(word, 31);
+  word *= PRIME_1;
+  h ^= word;
+  return rotl64(h, 27) * PRIME_1 + PRIME_4;
+}
+
+/*
+ * Original additive function (sum of bytes). Kept only as a baseline for the
+ * distribution report, it should not be used for real tables.
+ */
+uint64_t ht_hash_additive(const char *key, size_t length)
+{
+  const unsigned char *bytes = (const unsigned char*)key;
+  uint64_t result = 1;
+  for (size_t i = 0; i < length; i++)
+  {
+    result += bytes[i];
+  }
+
+  // Spread the small sum over the whole range so ht_hash_index can use it
+  return result * PRIME_1;
+}
+
+/*
+ * Multiply-xorshift hash for short keys. One multiplication per byte and no
+ * loads past the end of the key.
+ */
+uint64_t ht_hash_short(const char *key, size_t length)
+{
+  const unsigned char *bytes = (const unsigned char*)key;
+  uint64_t h = HT_SEED ^ ((uint64_t)length * PRIME_3);
+
+  for (size_t i = 0; i < length; i++)
+  {
+    h ^= bytes[i];
+    h *= PRIME_1;
+  }
+
+  return fmix64(h);
+}
+
+/*
+ * Wide-word hash for long keys. Consumes eight bytes per step, the tail is
+ * zero padded into one last word.
+ */
+uint64_t ht_hash_wide(const char *key, size_t length)
+{
+  const char *p = key;
+  uint64_t h = HT_SEED ^ ((uint64_t)length * PRIME_5);
+
+  while (length >= 8)
+  {
+    uint64_t word;
+    memcpy(&word, p, 8);
+    h = wide_round(h, word);
+
+    p += 8;
+    length -= 8;
+  }
+
+  if (length > 0)
+  {
+    uint64_t word = 0;
+    memcpy(&word, p, length);
+    h = wide_round(h, word);
+  }
+
+  return fmix64(h);
+}
+
+#ifdef HT_HASH_AVX2
+
+// 64-bit lane multiplication by a constant built from 32-bit multiplies
+__attribute__((target("avx2")))
+static inline __m256i mul64_avx2(__m256i a, uint64_t b)
+{
+  __m256i b_lo = _mm256_set1_epi64x((long long)(b & 0xffffffffULL));
+  __m256i b_hi = _mm256_set1_epi64x((long long)(b >> 32));
+
+  __m256i low = _mm256_mul_epu32(a, b_lo);
+  __m256i cross = _mm256_add_epi64(
+      _mm256_mul_epu32(_mm256_srli_epi64(a, 32), b_lo),
+      _mm256_mul_epu32(a, b_hi));
+  return _mm256_add_epi64(low, _mm256_slli_epi64(cross, 32));
+}
+
+__attribute__((target("avx2")))
+static inline __m256i fmix64_avx2(__m256i h)
+{
+  h = _mm256_xor_si256(h, _mm256_srli_epi64(h, 33));
+  h = mul64_avx2(h, 0xff51afd7ed558ccdULL);
+  h = _mm256_xor_si256(h, _mm256_srli_epi64(h, 33));
+  h = mul64_avx2(h, 0xc4ceb9fe1a85ec53ULL);
+  return _mm256_xor_si256(h, _mm256_srli_epi64(h, 33));
+}
+
+/*
+ * Loads key of at most 16 bytes into two zero padded little-endian words
+ * without touching memory past its end.
+ */
+static inline void load16(const char *key, size_t length, uint64_t *low,
+                          uint64_t *high)
+{
+  const unsigned char *bytes = (const unsigned char*)key;
+  uint32_t a, b;
+
+  if (length >= 8)
+  {
+    memcpy(low, key, 8);
+    memcpy(high, key + length - 8, 8);
+    *high = length > 8 ? *high >> (8 * (16 - length)) : 0;
+  }
+  else if (length >= 4)
+  {
+    memcpy(&a, key, 4);
+    memcpy(&b, key + length - 4, 4);
+    *low = a | ((uint64_t)b << (8 * (length - 4)));
+    *high = 0;
+  }
+  else
+  {
+    *low = length == 0 ? 0
+                       : bytes[0] | (uint64_t)bytes[length / 2] << (8 * (length / 2)) |
+                             (uint64_t)bytes[length - 1] << (8 * (length - 1));
+    *high = 0;
+  }
+}
+
+/*
+ * ht_hash_short of HT_HASH_LANES keys of at most HT_HASH_VECTOR_MAX bytes,
+ * one key per 64-bit lane. The lanes are spread over several registers so
+ * the multiplication chains of the registers overlap. Each step consumes the
+ * lowest byte of the lane words and shifts them; steps past the shortest key
+ * keep the state of lanes whose key already ended.
+ */
+__attribute__((target("avx2")))
+static void ht_hash_short_avx2(const char *keys[], const size_t lengths[],
+                               uint64_t hashes[])
+{
+  __m256i words[HT_HASH_LANES / 4], high[HT_HASH_LANES / 4];
+  __m256i length[HT_HASH_LANES / 4], h[HT_HASH_LANES / 4];
+  __m256i byte_mask = _mm256_set1_epi64x(0xff);
+  size_t shortest = HT_HASH_VECTOR_MAX;
+  size_t longest = 0;
+
+  // Vectors are built from registers, a vector load of just stored lane
+  // words would stall on store forwarding
+  for (int v = 0; v < HT_HASH_LANES / 4; v++)
+  {
+    uint64_t lo[4], hi[4];
+    for (int lane = 0; lane < 4; lane++)
+    {
+      size_t l = lengths[4 * v + lane];
+      load16(keys[4 * v + lane], l, &lo[lane], &hi[lane]);
+      if (l < shortest)
+        shortest = l;
+      if (l > longest)
+        longest = l;
+    }
+
+    words[v] = _mm256_set_epi64x((long long)lo[3], (long long)lo[2],
+                                 (long long)lo[1], (long long)lo[0]);
+    high[v] = _mm256_set_epi64x((long long)hi[3], (long long)hi[2],
+                                (long long)hi[1], (long long)hi[0]);
+    length[v] = _mm256_set_epi64x(
+        (long long)lengths[4 * v + 3], (long long)lengths[4 * v + 2],
+        (long long)lengths[4 * v + 1], (long long)lengths[4 * v]);
+    h[v] = _mm256_xor_si256(_mm256_set1_epi64x((long long)HT_SEED),
+                            mul64_avx2(length[v], PRIME_3));
+  }
+
+  for (size_t i = 0; i < longest; i++)
+  {
+    if (i == 8)
+    {
+      for (int v = 0; v < HT_HASH_LANES / 4; v++)
+        words[v] = high[v];
+    }
+
+    __m256i step = _mm256_set1_epi64x((long long)i);
+    for (int v = 0; v < HT_HASH_LANES / 4; v++)
+    {
+      __m256i bytes = _mm256_and_si256(words[v], byte_mask);
+      __m256i next = mul64_avx2(_mm256_xor_si256(h[v], bytes), PRIME_1);
+      h[v] = i < shortest ? next
+                          : _mm256_blendv_epi8(h[v], next,
+                                               _mm256_cmpgt_epi64(length[v], step));
+      words[v] = _mm256_srli_epi64(words[v], 8);
+    }
+  }
+
+  for (int v = 0; v < HT_HASH_LANES / 4; v++)
+    _mm256_storeu_si256((__m256i*)&hashes[4 * v], fmix64_avx2(h[v]));
+}
+
+// Whether the selected variant hashes a key of length with ht_hash_short
+// and the key fits the lanes of the vector kernel
+static inline bool ht_hash_vector_fits(size_t length)
+{
+#if HT_HASH == HT_HASH_ADAPTIVE
+  return length >= HT_HASH_VECTOR_MIN && length <= HT_HASH_VECTOR_MAX &&
+         length <= HT_HASH_SHORT_MAX;
+#else
+  return length >= HT_HASH_VECTOR_MIN && length <= HT_HASH_VECTOR_MAX;
+#endif
+}
+
+/*
+ * Keys that fit go HT_HASH_LANES at a time through the vector kernel, the
+ * others are hashed one by one. A run of fitting keys is hashed in place,
+ * otherwise they are gathered first.
+ */
+static void ht_hash_many_avx2(const char *keys[], const size_t lengths[],
+                              int count, uint64_t hashes[])
+{
+  const char *lane_keys[HT_HASH_LANES];
+  size_t lane_lengths[HT_HASH_LANES];
+  int lane_index[HT_HASH_LANES];
+  uint64_t lane_hashes[HT_HASH_LANES];
+  int lanes = 0;
+
+  for (int i = 0; i < count; i++)
+  {
+    if (lanes == 0 && count - i >= HT_HASH_LANES)
+    {
+      int run = 0;
+      while (run < HT_HASH_LANES && ht_hash_vector_fits(lengths[i + run]))
+        run++;
+
+      if (run == HT_HASH_LANES)
+      {
+        ht_hash_short_avx2(&keys[i], &lengths[i], &hashes[i]);
+        i += HT_HASH_LANES - 1;
+        continue;
+      }
+    }
+
+    if (!ht_hash_vector_fits(lengths[i]))
+    {
+      hashes[i] = ht_hash(keys[i], lengths[i]);
+      continue;
+    }
+
+    lane_keys[lanes] = keys[i];
+    lane_lengths[lanes] = lengths[i];
+    lane_index[lanes] = i;
+    if (++lanes == HT_HASH_LANES)
+    {
+      ht_hash_short_avx2(lane_keys, lane_lengths, lane_hashes);
+      for (int lane = 0; lane < HT_HASH_LANES; lane++)
+        hashes[lane_index[lane]] = lane_hashes[lane];
+      lanes = 0;
+    }
+  }
+
+  for (int lane = 0; lane < lanes; lane++)
+    hashes[lane_index[lane]] = ht_hash(lane_keys[lane], lane_lengths[lane]);
+}
+
+#endif
+
+/*
+ * Hash used by the table, selected with -DHT_HASH.
+ */
+uint64_t ht_hash(const char *key, size_t length)
+{
+#if HT_HASH == HT_HASH_ADDITIVE
+  return ht_hash_additive(key, length);
+#elif HT_HASH == HT_HASH_SHORT
+  return ht_hash_short(key, length);
+#elif HT_HASH == HT_HASH_WIDE
+  return ht_hash_wide(key, length);
+#else
+  if (length <= HT_HASH_SHORT_MAX)
+    return ht_hash_short(key, length);
+  return ht_hash_wide(key, length);
+#endif
+}
+
+const char *ht_hash_name(void)
+{
+#if HT_HASH == HT_HASH_ADDITIVE
+  return "additive";
+#elif HT_HASH == HT_HASH_SHORT
+  return "short";
+#elif HT_HASH == HT_HASH_WIDE
+  return "wide";
+#else
+  return "adaptive";
+#endif
+}
+
+/*
+ * Maps a hash to a bucket index from <0,size-1>.
+ *
+ * Uses the high 32 bits of the hash and a multiply-shift range reduction
+ * instead of a modulo, so any table size works and no division is needed.
+ */
+int ht_hash_index(uint64_t hash, int size)
+{
+  return (int)(((hash >> 32) * (uint64_t)size) >> 32);
+}
+
+/*
+ * Returns the first hash position (the high 32 bits of a hash) that
+ * ht_hash_index maps to index, or HT_HASH_POSITIONS for index == size.
+ *
+ * For any size the buckets cover consecutive ranges of positions in
+ * increasing order, so a position stays meaningful across resizes.
+ */
+uint64_t ht_hash_position(int index, int size)
+{
+  return (((uint64_t)index << 32) + size - 1) / size;
+}
+
+/*
+ * Hashes count keys at once, hashes[i] equals ht_hash(keys[i], lengths[i]).
+ *
+ * Keys are hashed one by one with ht_hash. Built with -DHT_HASH_AVX2 on an
+ * x86-64 CPU with AVX2, keys of HT_HASH_VECTOR_MIN to HT_HASH_VECTOR_MAX bytes
+ * are hashed HT_HASH_LANES (16) at a time, four per register, when a batch
+ * has at least HT_HASH_LANES of them; the other keys still use ht_hash.
+ */
+void ht_hash_many(const char *keys[], const size_t lengths[], int count,
+                  uint64_t hashes[])
+{
+#ifdef HT_HASH_AVX2
+  int fitting = 0;
+  for (int i = 0; i < count; i++)
+    fitting += ht_hash_vector_fits(lengths[i]);
+
+  if (fitting >= HT_HASH_LANES && __builtin_cpu_supports("avx2"))
+  {
+    ht_hash_many_avx2(keys, lengths, count, hashes);
+    return;
+  }
+#endif
+
+  for (int i = 0; i < count; i++)
+  {
+    hashes[i] = ht_hash(keys[i], lengths[i]);
+  }
+}
+
+/*
+ * Name of the kernel used by ht_hash_many on this CPU.
+ */
+const char *ht_hash_kernel(void)
+{
+#ifdef HT_HASH_AVX2
+  if (__builtin_cpu_supports("avx2"))
+    return "avx2";
+#endif
+  return "scalar";
+}
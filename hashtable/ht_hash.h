@@ -0,0 +1,48 @@
+/*
+ * Hlavičkový súbor pre rozptyľovacie funkcie tabuľky.
+ *
+ * All functions return an unsigned 64-bit hash of the first length bytes of
+ * key. The function used by the table is chosen at build time with
+ * -DHT_HASH=<variant>, see ht_hash().
+ */
+
+#ifndef IAL_HASHTABLE_HT_HASH_H
+#define IAL_HASHTABLE_HT_HASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Available hash variants for -DHT_HASH
+#define HT_HASH_ADDITIVE 0 // original byte sum, kept only for comparison
+#define HT_HASH_SHORT 1    // multiply-xorshift, one byte per step
+#define HT_HASH_WIDE 2     // wide-word, eight bytes per step
+#define HT_HASH_ADAPTIVE 3 // short for keys up to HT_HASH_SHORT_MAX, else wide
+
+#ifndef HT_HASH
+#define HT_HASH HT_HASH_ADAPTIVE
+#endif
+
+// Number of 32-bit hash positions, see ht_hash_position
+#define HT_HASH_POSITIONS (UINT64_C(1) << 32)
+
+// Longest key hashed by ht_hash_short in the adaptive variant
+#define HT_HASH_SHORT_MAX 16
+
+// Shortest and longest key ht_hash_many hashes in vector lanes with
+// -DHT_HASH_AVX2; shorter keys are hashed faster one by one
+#define HT_HASH_VECTOR_MIN 13
+#define HT_HASH_VECTOR_MAX 16
+
+uint64_t ht_hash_additive(const char *key, size_t length);
+uint64_t ht_hash_short(const char *key, size_t length);
+uint64_t ht_hash_wide(const char *key, size_t length);
+uint64_t ht_hash(const char *key, size_t length);
+void ht_hash_many(const char *keys[], const size_t lengths[], int count,
+                  uint64_t hashes[]);
+
+const char *ht_hash_name(void);
+const char *ht_hash_kernel(void);
+int ht_hash_index(uint64_t hash, int size);
+uint64_t ht_hash_position(int index, int size);
+
+#endif
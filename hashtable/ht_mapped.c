@@ -0,0 +1,276 @@
+/*
+ * Uloženie tabuľky do súboru a vyhľadávanie v namapovanom súbore
+ *
+ * Layout of the file, all offsets are from its start:
+ *
+ *   ht_mapped_header_t
+ *   uint64_t buckets[bucket_count]   offset of the first item, 0 if empty
+ *   ht_mapped_item_t items[item_count]
+ *   keys                             keys terminated by '\0'
+ *
+ * Items are written grouped by bucket, so walking a chain reads consecutive
+ * records. The bucket count equals the item count (load factor 1).
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "ht_mapped.h"
+#include "ht_hash.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+ * Stores pointers to all items of the table into items and returns their
+ * number.
+ */
+static int ht_collect(ht_table_t *table, ht_item_t **items)
+{
+  int count = 0;
+
+#ifdef HT_SWISS
+  if (table->ctrl == NULL) return 0;
+
+  for (int i = 0; i < table->size; i++)
+  {
+    if (table->ctrl[i] >= 0)
+      items[count++] = &table->slots[i];
+  }
+#elif defined(HT_CUCKOO)
+  if (table->buckets == NULL) return 0;
+
+  for (int i = 0; i < table->size / HT_CUCKOO_SLOTS; i++)
+  {
+    for (int j = 0; j < HT_CUCKOO_SLOTS; j++)
+    {
+      if (table->buckets[i].items[j] != NULL)
+        items[count++] = table->buckets[i].items[j];
+    }
+  }
+  for (int i = 0; i < table->stash_count; i++)
+    items[count++] = table->stash[i];
+#else
+  if (table->buckets == NULL) return 0;
+
+  for (int i = 0; i < table->size; i++)
+  {
+    for (ht_item_t *item = table->buckets[i]; item != NULL; item = item->next)
+      items[count++] = item;
+  }
+  if (table->old_buckets != NULL)
+  {
+    for (int i = table->rehash_index; i < table->old_size; i++)
+    {
+      for (ht_item_t *item = table->old_buckets[i]; item != NULL; item = item->next)
+        items[count++] = item;
+    }
+  }
+#endif
+
+  return count;
+}
+
+/*
+ * Uloženie tabuľky do súboru.
+ *
+ * Returns false if the table could not be written completely.
+ */
+bool ht_save(ht_table_t *table, const char *path)
+{
+  if (table == NULL || path == NULL) return false;
+
+  int count = table->count;
+  uint32_t bucket_count = count > 0 ? (uint32_t)count : 1;
+
+  ht_item_t **items = (ht_item_t**)malloc((count + 1) * sizeof(ht_item_t*));
+  ht_item_t **sorted = (ht_item_t**)malloc((count + 1) * sizeof(ht_item_t*));
+  uint64_t *buckets = (uint64_t*)calloc(bucket_count + 1, sizeof(uint64_t));
+  ht_mapped_item_t *records = (ht_mapped_item_t*)malloc((count + 1) * sizeof(ht_mapped_item_t));
+  if (items == NULL || sorted == NULL || buckets == NULL || records == NULL)
+  {
+    free(items);
+    free(sorted);
+    free(buckets);
+    free(records);
+    return false;
+  }
+
+  count = ht_collect(table, items);
+
+  // Counting sort by bucket, buckets[i + 1] counts the items of bucket i
+  for (int i = 0; i < count; i++)
+    buckets[ht_hash_index(items[i]->hash, bucket_count) + 1]++;
+  for (uint32_t i = 0; i < bucket_count; i++)
+    buckets[i + 1] += buckets[i];
+  for (int i = 0; i < count; i++)
+    sorted[buckets[ht_hash_index(items[i]->hash, bucket_count)]++] = items[i];
+
+  // After the sort buckets[i] is the end of bucket i
+  uint64_t items_offset = sizeof(ht_mapped_header_t) + bucket_count * sizeof(uint64_t);
+  uint64_t keys_offset = items_offset + count * sizeof(ht_mapped_item_t);
+  uint64_t key = keys_offset;
+
+  for (int i = 0; i < count; i++)
+  {
+    uint32_t index = ht_hash_index(sorted[i]->hash, bucket_count);
+    bool last = i + 1 == count ||
+                ht_hash_index(sorted[i + 1]->hash, bucket_count) != index;
+
+    records[i].hash = sorted[i]->hash;
+    records[i].next = last ? 0 : items_offset + (i + 1) * sizeof(ht_mapped_item_t);
+    records[i].key = key;
+    records[i].length = sorted[i]->length;
+    records[i].value = sorted[i]->value;
+    key += sorted[i]->length + 1;
+  }
+
+  // Convert bucket ends to offsets of the first items
+  for (uint32_t i = bucket_count; i-- > 0;)
+  {
+    uint64_t start = i > 0 ? buckets[i - 1] : 0;
+    buckets[i] = start < buckets[i] ? items_offset + start * sizeof(ht_mapped_item_t) : 0;
+  }
+
+  ht_mapped_header_t header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, HT_MAPPED_MAGIC, sizeof(header.magic));
+  header.version = HT_MAPPED_VERSION;
+  header.hash = HT_HASH;
+  header.bucket_count = bucket_count;
+  header.item_count = count;
+  header.items = items_offset;
+  header.keys = keys_offset;
+  header.size = key;
+
+  bool ok = false;
+  FILE *file = fopen(path, "wb");
+  if (file != NULL)
+  {
+    ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+         fwrite(buckets, sizeof(uint64_t), bucket_count, file) == bucket_count &&
+         fwrite(records, sizeof(ht_mapped_item_t), count, file) == (size_t)count;
+    for (int i = 0; ok && i < count; i++)
+      ok = fwrite(sorted[i]->key, 1, sorted[i]->length + 1, file) == sorted[i]->length + 1;
+    ok = fclose(file) == 0 && ok;
+  }
+
+  free(items);
+  free(sorted);
+  free(buckets);
+  free(records);
+  return ok;
+}
+
+/*
+ * Namapovanie tabuľky zo súboru.
+ *
+ * Only the header is checked, the rest of the file is used as it is. Returns
+ * NULL if the file cannot be mapped or was not written by ht_save of a build
+ * with the same hash variant.
+ */
+ht_mapped_t *ht_open_mapped(const char *path)
+{
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) return NULL;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(ht_mapped_header_t))
+  {
+    close(fd);
+    return NULL;
+  }
+
+  void *base = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) return NULL;
+
+  const ht_mapped_header_t *header = (const ht_mapped_header_t*)base;
+  if (memcmp(header->magic, HT_MAPPED_MAGIC, sizeof(header->magic)) != 0 ||
+      header->version != HT_MAPPED_VERSION || header->hash != HT_HASH ||
+      header->bucket_count == 0 || header->size != (uint64_t)st.st_size ||
+      header->items != sizeof(ht_mapped_header_t) + header->bucket_count * sizeof(uint64_t) ||
+      header->keys != header->items + header->item_count * sizeof(ht_mapped_item_t) ||
+      header->keys > header->size)
+  {
+    munmap(base, st.st_size);
+    return NULL;
+  }
+
+  ht_mapped_t *map = (ht_mapped_t*)malloc(sizeof(ht_mapped_t));
+  if (map == NULL)
+  {
+    munmap(base, st.st_size);
+    return NULL;
+  }
+
+  map->base = (const char*)base;
+  map->size = st.st_size;
+  map->header = header;
+  map->buckets = (const uint64_t*)(map->base + sizeof(ht_mapped_header_t));
+  return map;
+}
+
+/*
+ * Zrušenie mapovania tabuľky.
+ */
+void ht_close_mapped(ht_mapped_t *map)
+{
+  if (map == NULL) return;
+
+  munmap((void*)map->base, map->size);
+  free(map);
+}
+
+/*
+ * Vyhľadanie prvku v namapovanej tabuľke.
+ *
+ * Offsets outside of the item array end the chain, so a damaged file cannot
+ * make a lookup read past the mapping, and a chain longer than the number of
+ * items is cut off, so a cycle in it cannot make the lookup loop forever.
+ */
+const ht_mapped_item_t *ht_mapped_search(const ht_mapped_t *map, const char *key)
+{
+  if (map == NULL || key == NULL) return NULL;
+
+  size_t length = strlen(key);
+  uint64_t hash = ht_hash(key, length);
+  uint64_t offset = map->buckets[ht_hash_index(hash, map->header->bucket_count)];
+
+  for (uint64_t steps = 0; steps < map->header->item_count &&
+       offset >= map->header->items && offset < map->header->keys &&
+       (offset - map->header->items) % sizeof(ht_mapped_item_t) == 0; steps++)
+  {
+    const ht_mapped_item_t *item = (const ht_mapped_item_t*)(map->base + offset);
+    if (item->hash == hash && item->length == length &&
+        item->key >= map->header->keys && item->key + length < map->size &&
+        memcmp(map->base + item->key, key, length) == 0)
+      return item;
+
+    offset = item->next;
+  }
+
+  return NULL;
+}
+
+/*
+ * Získanie hodnoty z namapovanej tabuľky.
+ *
+ * Returns a pointer into the read-only mapping or NULL if the key is absent.
+ */
+const float *ht_mapped_get(const ht_mapped_t *map, const char *key)
+{
+  const ht_mapped_item_t *item = ht_mapped_search(map, key);
+  return item != NULL ? &item->value : NULL;
+}
+
+/*
+ * Kľúč prvku namapovanej tabuľky.
+ */
+const char *ht_mapped_key(const ht_mapped_t *map, const ht_mapped_item_t *item)
+{
+  return map->base + item->key;
+}
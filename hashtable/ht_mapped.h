@@ -0,0 +1,64 @@
+/*
+ * Hlavičkový súbor pre uloženie tabuľky do súboru a jej mapovanie do pamäte.
+ *
+ * ht_save writes a position independent image of a table: a header, an array
+ * of bucket offsets, the items (chained by file offsets instead of pointers)
+ * and one pool with all keys. ht_open_mapped maps such a file read-only and
+ * lookups run directly on the mapping, so opening takes the same time for
+ * any table size.
+ *
+ * The image uses the byte order of the machine that wrote it and stores the
+ * hash variant it was built with; a build with another HT_HASH refuses it.
+ */
+
+#ifndef IAL_HASHTABLE_HT_MAPPED_H
+#define IAL_HASHTABLE_HT_MAPPED_H
+
+#include "hashtable.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#define HT_MAPPED_MAGIC "IALHTMAP"
+#define HT_MAPPED_VERSION 1
+
+// Hlavička súboru
+typedef struct ht_mapped_header {
+  char magic[8];         // HT_MAPPED_MAGIC
+  uint32_t version;      // HT_MAPPED_VERSION
+  uint32_t hash;         // HT_HASH použitý pri ukladaní
+  uint32_t bucket_count; // počet zoznamov synoným
+  uint32_t item_count;   // počet položiek
+  uint64_t items;        // offset poľa položiek
+  uint64_t keys;         // offset poľa kľúčov
+  uint64_t size;         // veľkosť súboru
+} ht_mapped_header_t;
+
+// Položka v súbore, offsety sú od začiatku súboru
+typedef struct ht_mapped_item {
+  uint64_t hash;   // rozptylová hodnota kľúča
+  uint64_t next;   // offset ďalšieho synonyma, 0 na konci zoznamu
+  uint64_t key;    // offset kľúča ukončeného nulou
+  uint32_t length; // dĺžka kľúča
+  float value;     // hodnota prvku
+} ht_mapped_item_t;
+
+// Tabuľka namapovaná zo súboru
+typedef struct ht_mapped {
+  const char *base;                  // začiatok mapovania
+  size_t size;                       // veľkosť mapovania
+  const ht_mapped_header_t *header;  // hlavička
+  const uint64_t *buckets;           // offsety prvých položiek zoznamov
+} ht_mapped_t;
+
+bool ht_save(ht_table_t *table, const char *path);
+
+ht_mapped_t *ht_open_mapped(const char *path);
+void ht_close_mapped(ht_mapped_t *map);
+
+const ht_mapped_item_t *ht_mapped_search(const ht_mapped_t *map,
+                                         const char *key);
+const float *ht_mapped_get(const ht_mapped_t *map, const char *key);
+const char *ht_mapped_key(const ht_mapped_t *map,
+                          const ht_mapped_item_t *item);
+
+#endif
@@ -0,0 +1,359 @@
+/*
+ * Zásobník kľúčov
+ *
+ * Records are cut from the newest chunk, a key longer than HT_POOL_CHUNK
+ * gets a chunk of its own placed behind it. The interning index is an open
+ * addressing array of record pointers with linear probing; released records
+ * leave a tombstone in it until the index is rebuilt.
+ */
+
+#include "ht_pool.h"
+#include "ht_hash.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Blok zásobníka
+typedef struct ht_pool_chunk {
+  struct ht_pool_chunk *next; // starší blok
+  size_t size;                // veľkosť dát
+  size_t used;                // obsadená časť dát
+  max_align_t data[];
+} ht_pool_chunk_t;
+
+// Index entry of a released record
+static ht_pool_string_t ht_pool_tombstone;
+
+static size_t ht_pool_record_size(size_t length)
+{
+  size_t size = sizeof(ht_pool_string_t) + length + 1;
+  return (size + sizeof(uint64_t) - 1) / sizeof(uint64_t) * sizeof(uint64_t);
+}
+
+static ht_pool_string_t *ht_pool_header(const char *key)
+{
+  return (ht_pool_string_t*)(key - offsetof(ht_pool_string_t, bytes));
+}
+
+static ht_pool_chunk_t *ht_pool_chunk_new(size_t size)
+{
+  ht_pool_chunk_t *chunk = (ht_pool_chunk_t*)malloc(sizeof(ht_pool_chunk_t) + size);
+  if (chunk == NULL) return NULL;
+
+  chunk->next = NULL;
+  chunk->size = size;
+  chunk->used = 0;
+  return chunk;
+}
+
+/*
+ * Builds an index of size entries holding the live records of the old one.
+ * Returns false, keeping the old index, if memory runs out.
+ */
+static bool ht_pool_reindex(ht_pool_t *pool, uint32_t size)
+{
+  ht_pool_string_t **index = (ht_pool_string_t**)calloc(size, sizeof(ht_pool_string_t*));
+  if (index == NULL) return false;
+
+  uint32_t used = 0;
+  for (uint32_t i = 0; i < pool->index_size; i++)
+  {
+    ht_pool_string_t *string = pool->index[i];
+    if (string == NULL || string == &ht_pool_tombstone)
+      continue;
+
+    uint32_t slot = ht_hash_index(string->link.hash, size);
+    while (index[slot] != NULL)
+      slot = (slot + 1) & (size - 1);
+    index[slot] = string;
+    used++;
+  }
+
+  free(pool->index);
+  pool->index = index;
+  pool->index_size = size;
+  pool->index_used = used;
+  return true;
+}
+
+/*
+ * Vytvorenie zásobníka.
+ *
+ * With intern set, equal keys added to the pool share one record. Returns
+ * NULL if memory runs out.
+ */
+ht_pool_t *ht_pool_new(bool intern)
+{
+  ht_pool_t *pool = (ht_pool_t*)calloc(1, sizeof(ht_pool_t));
+  if (pool == NULL) return NULL;
+
+  pool->intern = intern;
+  if (intern)
+  {
+    pool->index = (ht_pool_string_t**)calloc(HT_POOL_INDEX_SIZE, sizeof(ht_pool_string_t*));
+    if (pool->index == NULL)
+    {
+      free(pool);
+      return NULL;
+    }
+    pool->index_size = HT_POOL_INDEX_SIZE;
+  }
+  return pool;
+}
+
+static void ht_pool_free_chunks(ht_pool_chunk_t *chunk)
+{
+  while (chunk != NULL)
+  {
+    ht_pool_chunk_t *next = chunk->next;
+    free(chunk);
+    chunk = next;
+  }
+}
+
+/*
+ * Uvoľnenie zásobníka.
+ *
+ * All keys go at once, the tables using the pool must not be used anymore.
+ */
+void ht_pool_free(ht_pool_t *pool)
+{
+  if (pool == NULL) return;
+
+  ht_pool_free_chunks(pool->chunks);
+  free(pool->index);
+  free(pool);
+}
+
+/*
+ * Vyprázdnenie zásobníka.
+ *
+ * Keeps the newest chunk for the keys added next.
+ */
+void ht_pool_clear(ht_pool_t *pool)
+{
+  if (pool == NULL) return;
+
+  if (pool->chunks != NULL)
+  {
+    ht_pool_free_chunks(pool->chunks->next);
+    pool->chunks->next = NULL;
+    pool->chunks->used = 0;
+  }
+  if (pool->index != NULL)
+    memset(pool->index, 0, pool->index_size * sizeof(ht_pool_string_t*));
+
+  pool->index_used = 0;
+  pool->bytes = 0;
+  pool->garbage = 0;
+  pool->refs = 0;
+}
+
+/*
+ * Appends a record for the key. Returns NULL if memory runs out.
+ */
+static ht_pool_string_t *ht_pool_append(ht_pool_t *pool, const char *key,
+                                        size_t length, uint64_t hash)
+{
+  size_t size = ht_pool_record_size(length);
+  ht_pool_chunk_t *chunk = pool->chunks;
+
+  if (chunk == NULL || chunk->size - chunk->used < size)
+  {
+    bool own = size > HT_POOL_CHUNK;
+    chunk = ht_pool_chunk_new(own ? size : HT_POOL_CHUNK);
+    if (chunk == NULL) return NULL;
+
+    // A chunk of its own goes behind the newest one, which stays in use
+    if (own && pool->chunks != NULL)
+    {
+      chunk->next = pool->chunks->next;
+      pool->chunks->next = chunk;
+    }
+    else
+    {
+      chunk->next = pool->chunks;
+      pool->chunks = chunk;
+    }
+  }
+
+  ht_pool_string_t *string = (ht_pool_string_t*)((char*)chunk->data + chunk->used);
+  chunk->used += size;
+  pool->bytes += size;
+
+  string->link.hash = hash;
+  string->refs = 1;
+  string->length = (uint32_t)length;
+  memcpy(string->bytes, key, length);
+  string->bytes[length] = '\0';
+  return string;
+}
+
+/*
+ * Pridanie kľúča do zásobníka.
+ *
+ * hash is the ht_hash of the key. Returns the stored copy of the key, which
+ * holds one reference until ht_pool_release, or NULL if memory runs out.
+ */
+const char *ht_pool_add(ht_pool_t *pool, const char *key, size_t length,
+                        uint64_t hash)
+{
+  if (pool == NULL) return NULL;
+
+  if (!pool->intern)
+  {
+    ht_pool_string_t *string = ht_pool_append(pool, key, length, hash);
+    if (string == NULL) return NULL;
+    pool->refs++;
+    return string->bytes;
+  }
+
+  // Keep at most half of the index taken, tombstones included
+  if (2 * (pool->index_used + 1) > pool->index_size)
+  {
+    uint32_t size = HT_POOL_INDEX_SIZE;
+    uint32_t live = 0;
+    for (uint32_t i = 0; i < pool->index_size; i++)
+      live += pool->index[i] != NULL && pool->index[i] != &ht_pool_tombstone;
+    while (size < 4 * (live + 1))
+      size *= 2;
+    if (!ht_pool_reindex(pool, size)) return NULL;
+  }
+
+  uint32_t slot = ht_hash_index(hash, pool->index_size);
+  uint32_t free_slot = pool->index_size;
+  for (; pool->index[slot] != NULL; slot = (slot + 1) & (pool->index_size - 1))
+  {
+    ht_pool_string_t *string = pool->index[slot];
+    if (string == &ht_pool_tombstone)
+    {
+      if (free_slot == pool->index_size)
+        free_slot = slot;
+    }
+    else if (string->link.hash == hash && string->length == length &&
+             memcmp(string->bytes, key, length) == 0)
+    {
+      string->refs++;
+      pool->refs++;
+      return string->bytes;
+    }
+  }
+
+  ht_pool_string_t *string = ht_pool_append(pool, key, length, hash);
+  if (string == NULL) return NULL;
+
+  if (free_slot == pool->index_size)
+  {
+    free_slot = slot;
+    pool->index_used++;
+  }
+  pool->index[free_slot] = string;
+  pool->refs++;
+  return string->bytes;
+}
+
+/*
+ * Uvoľnenie odkazu na kľúč.
+ *
+ * key is a pointer returned by ht_pool_add. The record becomes garbage once
+ * its last reference is released.
+ */
+void ht_pool_release(ht_pool_t *pool, const char *key)
+{
+  if (pool == NULL || key == NULL) return;
+
+  ht_pool_string_t *string = ht_pool_header(key);
+  pool->refs--;
+  if (--string->refs > 0) return;
+
+  pool->garbage += ht_pool_record_size(string->length);
+  if (pool->intern)
+  {
+    uint32_t slot = ht_hash_index(string->link.hash, pool->index_size);
+    while (pool->index[slot] != string)
+      slot = (slot + 1) & (pool->index_size - 1);
+    pool->index[slot] = &ht_pool_tombstone;
+  }
+}
+
+/*
+ * Points the key of item to its record in the new chunk, copying the record
+ * the first time. A copied record keeps the new address in its old place.
+ */
+static void ht_pool_move(ht_item_t *item, void *data)
+{
+  ht_pool_chunk_t *chunk = (ht_pool_chunk_t*)data;
+  ht_pool_string_t *string = ht_pool_header(item->key);
+
+  if (string->refs > 0)
+  {
+    size_t size = ht_pool_record_size(string->length);
+    ht_pool_string_t *copy = (ht_pool_string_t*)((char*)chunk->data + chunk->used);
+    memcpy(copy, string, size);
+    chunk->used += size;
+
+    string->refs = 0;
+    string->link.moved = copy;
+  }
+
+  item->key = string->link.moved->bytes;
+}
+
+/*
+ * Zhutnenie zásobníka.
+ *
+ * Copies the live keys into one new chunk, in the order the tables list
+ * them, and frees the old chunks with the garbage in them. tables must be
+ * all tables using the pool: the call checks that their items hold all its
+ * references and otherwise returns false without changing anything. Also
+ * returns false if memory runs out. Pointers to keys from before the call
+ * are no longer valid.
+ */
+bool ht_pool_compact(ht_pool_t *pool, ht_table_t *tables[], int count)
+{
+  if (pool == NULL) return false;
+
+  unsigned long items = 0;
+  for (int i = 0; i < count; i++)
+  {
+    if (tables[i]->pool != pool) return false;
+    items += tables[i]->count;
+  }
+  if (items != pool->refs) return false;
+
+  size_t live = pool->bytes - pool->garbage;
+  ht_pool_chunk_t *chunk = ht_pool_chunk_new(live > HT_POOL_CHUNK ? live : HT_POOL_CHUNK);
+  if (chunk == NULL) return false;
+
+  // Every live record is reached, so they all fit into the new chunk
+  for (int i = 0; i < count; i++)
+  {
+    uint64_t cursor = 0;
+    do
+    {
+      cursor = ht_scan(tables[i], cursor, ht_pool_move, chunk, tables[i]->count + 1);
+    } while (cursor != 0);
+  }
+
+  ht_pool_free_chunks(pool->chunks);
+  pool->chunks = chunk;
+  pool->bytes = chunk->used;
+  pool->garbage = 0;
+
+  if (pool->intern)
+  {
+    memset(pool->index, 0, pool->index_size * sizeof(ht_pool_string_t*));
+    pool->index_used = 0;
+    for (size_t offset = 0; offset < chunk->used;)
+    {
+      ht_pool_string_t *string = (ht_pool_string_t*)((char*)chunk->data + offset);
+      uint32_t slot = ht_hash_index(string->link.hash, pool->index_size);
+      while (pool->index[slot] != NULL)
+        slot = (slot + 1) & (pool->index_size - 1);
+      pool->index[slot] = string;
+      pool->index_used++;
+      offset += ht_pool_record_size(string->length);
+    }
+  }
+
+  return true;
+}
@@ -0,0 +1,61 @@
+/*
+ * Hlavičkový súbor pre zásobník kľúčov.
+ *
+ * The pool stores keys one after another in large chunks that are only
+ * appended to, so keys inserted together lie next to each other and a table
+ * using the pool gives all its keys back with a few frees. Every key is a
+ * string record (its header and the bytes with '\0'); a table refers to it by
+ * the pointer to its bytes, which stays valid until the pool is compacted.
+ *
+ * An interning pool can be shared by several tables: adding a key that is
+ * already stored only counts one more reference, so every distinct key is
+ * kept once. Released records stay in their chunk as garbage until
+ * ht_pool_compact copies the live ones into a fresh chunk.
+ */
+
+#ifndef IAL_HASHTABLE_HT_POOL_H
+#define IAL_HASHTABLE_HT_POOL_H
+
+#include "hashtable.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Bytes of a regular chunk, a longer key gets a chunk of its own
+#define HT_POOL_CHUNK 65536
+
+// Size of the interning index of an empty pool, a power of two
+#define HT_POOL_INDEX_SIZE 64
+
+// Reťazec uložený v zásobníku
+typedef struct ht_pool_string {
+  union {
+    uint64_t hash;                // rozptylová hodnota kľúča
+    struct ht_pool_string *moved; // nové umiestnenie počas zhutnenia
+  } link;
+  uint32_t refs;   // počet odkazov, 0 pre uvoľnený záznam
+  uint32_t length; // dĺžka kľúča
+  char bytes[];    // kľúč ukončený '\0'
+} ht_pool_string_t;
+
+// Zásobník kľúčov
+typedef struct ht_pool {
+  struct ht_pool_chunk *chunks; // bloky, najnovší prvý
+  bool intern;                  // zdieľať rovnaké kľúče
+  ht_pool_string_t **index;     // rozptýlený index pri intern, inak NULL
+  uint32_t index_size;          // počet miest indexu (mocnina dvoch)
+  uint32_t index_used;          // obsadené miesta indexu vrátane zmazaných
+  size_t bytes;                 // veľkosť všetkých záznamov v blokoch
+  size_t garbage;               // veľkosť uvoľnených záznamov
+  unsigned long refs;           // súčet odkazov všetkých záznamov
+} ht_pool_t;
+
+ht_pool_t *ht_pool_new(bool intern);
+void ht_pool_free(ht_pool_t *pool);
+void ht_pool_clear(ht_pool_t *pool);
+const char *ht_pool_add(ht_pool_t *pool, const char *key, size_t length,
+                        uint64_t hash);
+void ht_pool_release(ht_pool_t *pool, const char *key);
+bool ht_pool_compact(ht_pool_t *pool, ht_table_t *tables[], int count);
+
+#endif
@@ -0,0 +1,367 @@
+/*
+ * Tabuľka s rozptýlenými položkami v zdieľanej pamäti
+ *
+ * Layout of the object, all offsets are from its start:
+ *
+ *   hts_header_t
+ *   uint64_t buckets[bucket_count]   offset of the first item, 0 if empty
+ *   hts_item_t records ...           appended up to header->used
+ *
+ * A writer holding the lock makes the sequence odd, changes the table and
+ * makes it even again. A new record is complete before its offset is stored
+ * with release semantics, and readers load offsets with acquire semantics,
+ * so a reader never sees a half written record even before it checks the
+ * sequence. Offsets outside of the written records end a chain, a reader
+ * racing a writer therefore cannot leave the mapping.
+ *
+ * The lock is robust: if a writer dies holding it, the next one takes over
+ * and makes the sequence even again. Every single change becomes visible
+ * with one store, so the table is consistent at any point of a writer;
+ * readers that keep seeing a change in progress therefore read anyway after
+ * HTS_READ_RETRIES attempts instead of waiting for the next writer.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "ht_shared.h"
+#include "ht_hash.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Reads repeated while the sequence is odd or changes before a reader takes
+// what it sees, a writer that died holding the lock leaves it odd for good
+#define HTS_READ_RETRIES 1000
+
+static size_t hts_record_size(size_t length)
+{
+  size_t size = sizeof(hts_item_t) + length + 1;
+  return (size + sizeof(uint64_t) - 1) / sizeof(uint64_t) * sizeof(uint64_t);
+}
+
+/*
+ * Returns the record at offset, or NULL if the offset does not point to the
+ * start of a written record.
+ */
+static hts_item_t *hts_item(hts_table_t *table, uint64_t offset, uint64_t used)
+{
+  if (offset < table->header->items || offset >= used ||
+      offset % sizeof(uint64_t) != 0)
+    return NULL;
+  return (hts_item_t*)(table->base + offset);
+}
+
+static inline bool hts_item_matches(hts_item_t *item, const char *key,
+                                    size_t length, uint64_t hash)
+{
+  return item->hash == hash && item->length == length &&
+         memcmp(item->key, key, length) == 0;
+}
+
+static hts_table_t *hts_map(int fd, size_t size, bool writable)
+{
+  void *base = mmap(NULL, size, writable ? PROT_READ | PROT_WRITE : PROT_READ,
+                    MAP_SHARED, fd, 0);
+  if (base == MAP_FAILED) return NULL;
+
+  hts_table_t *table = (hts_table_t*)malloc(sizeof(hts_table_t));
+  if (table == NULL)
+  {
+    munmap(base, size);
+    return NULL;
+  }
+
+  table->base = (char*)base;
+  table->size = size;
+  table->header = (hts_header_t*)base;
+  table->buckets = (_Atomic uint64_t*)(table->base + sizeof(hts_header_t));
+  table->writable = writable;
+  return table;
+}
+
+/*
+ * Vytvorenie tabuľky v zdieľanej pamäti.
+ *
+ * name is the name of the shared memory object ("/name", see shm_open) and
+ * must not exist yet. size is the size of the whole object; records take
+ * their key plus about 32 bytes. The creating process gets a writable
+ * mapping. Returns NULL if the object cannot be created.
+ */
+hts_table_t *hts_create(const char *name, int buckets, size_t size)
+{
+  size_t items = sizeof(hts_header_t) + (size_t)buckets * sizeof(uint64_t);
+  if (name == NULL || buckets < 1 || size <= items) return NULL;
+
+  int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (fd < 0) return NULL;
+
+  hts_table_t *table = NULL;
+  if (ftruncate(fd, size) == 0)
+    table = hts_map(fd, size, true);
+  close(fd);
+  if (table == NULL)
+  {
+    shm_unlink(name);
+    return NULL;
+  }
+
+  hts_header_t *header = table->header;
+  pthread_mutexattr_t attr;
+  pthread_mutexattr_init(&attr);
+  pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+  pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+  pthread_mutex_init(&header->lock, &attr);
+  pthread_mutexattr_destroy(&attr);
+
+  // The object starts zeroed, so every bucket is already empty
+  header->version = HTS_VERSION;
+  header->hash = HT_HASH;
+  header->bucket_count = (uint32_t)buckets;
+  header->size = size;
+  header->items = items;
+  atomic_init(&header->used, items);
+  atomic_init(&header->sequence, 0);
+  atomic_init(&header->count, 0);
+
+  // The magic goes last, hts_open refuses a table still being set up
+  atomic_thread_fence(memory_order_release);
+  memcpy(header->magic, HTS_MAGIC, sizeof(header->magic));
+  return table;
+}
+
+/*
+ * Otvorenie existujúcej tabuľky.
+ *
+ * A process that only reads should pass writable false, its mapping is then
+ * read-only. Returns NULL if the object does not exist or was not created
+ * by hts_create of a build with the same hash variant.
+ */
+hts_table_t *hts_open(const char *name, bool writable)
+{
+  if (name == NULL) return NULL;
+
+  int fd = shm_open(name, writable ? O_RDWR : O_RDONLY, 0);
+  if (fd < 0) return NULL;
+
+  struct stat st;
+  hts_table_t *table = NULL;
+  if (fstat(fd, &st) == 0 && (size_t)st.st_size > sizeof(hts_header_t))
+    table = hts_map(fd, st.st_size, writable);
+  close(fd);
+  if (table == NULL) return NULL;
+
+  const hts_header_t *header = table->header;
+  if (memcmp(header->magic, HTS_MAGIC, sizeof(header->magic)) != 0 ||
+      header->version != HTS_VERSION || header->hash != HT_HASH ||
+      header->size != table->size || header->bucket_count == 0 ||
+      header->items != sizeof(hts_header_t) + header->bucket_count * sizeof(uint64_t) ||
+      header->items >= header->size)
+  {
+    hts_close(table);
+    return NULL;
+  }
+
+  atomic_thread_fence(memory_order_acquire);
+  return table;
+}
+
+/*
+ * Zrušenie mapovania tabuľky v tomto procese.
+ */
+void hts_close(hts_table_t *table)
+{
+  if (table == NULL) return;
+
+  munmap(table->base, table->size);
+  free(table);
+}
+
+/*
+ * Odstránenie zdieľaného objektu.
+ *
+ * Processes that have the table mapped keep using it, the memory is freed
+ * when the last one closes it.
+ */
+bool hts_unlink(const char *name)
+{
+  return name != NULL && shm_unlink(name) == 0;
+}
+
+/*
+ * Walks the chain of a key without taking the lock. Returns the item or
+ * NULL and, through link, the offset word that points to it.
+ */
+static hts_item_t *hts_find(hts_table_t *table, const char *key, size_t length,
+                            uint64_t hash, _Atomic uint64_t **link)
+{
+  uint64_t used = atomic_load_explicit(&table->header->used, memory_order_acquire);
+  _Atomic uint64_t *next = &table->buckets[ht_hash_index(hash, table->header->bucket_count)];
+
+  // More steps than records means the chain changed under a reader
+  for (uint64_t steps = 0; steps <= used / sizeof(hts_item_t); steps++)
+  {
+    uint64_t offset = atomic_load_explicit(next, memory_order_acquire);
+    hts_item_t *item = hts_item(table, offset, used);
+    if (item == NULL) return NULL;
+
+    if (hts_item_matches(item, key, length, hash))
+    {
+      if (link != NULL)
+        *link = next;
+      return item;
+    }
+    next = &item->next;
+  }
+
+  return NULL;
+}
+
+/*
+ * Získanie hodnoty z tabuľky.
+ *
+ * Takes no lock and writes nothing to the shared memory. Returns false if
+ * the key is not in the table. A lookup overlapping a change is repeated,
+ * at most HTS_READ_RETRIES times.
+ */
+bool hts_get(hts_table_t *table, const char *key, float *value)
+{
+  if (table == NULL || key == NULL) return false;
+
+  size_t length = strlen(key);
+  uint64_t hash = ht_hash(key, length);
+  atomic_uint *sequence = &table->header->sequence;
+
+  for (int attempt = 0; ; attempt++)
+  {
+    unsigned start = atomic_load_explicit(sequence, memory_order_acquire);
+
+    hts_item_t *item = hts_find(table, key, length, hash, NULL);
+    float found = item != NULL ? atomic_load_explicit(&item->value, memory_order_relaxed) : 0.0f;
+
+    atomic_thread_fence(memory_order_acquire);
+    bool stable = !(start & 1) &&
+                  atomic_load_explicit(sequence, memory_order_relaxed) == start;
+    if (!stable && attempt < HTS_READ_RETRIES)
+      continue;
+
+    if (item != NULL && value != NULL)
+      *value = found;
+    return item != NULL;
+  }
+}
+
+/*
+ * Takes the writer lock and makes the sequence odd. A lock left by a dead
+ * writer is taken over.
+ */
+static bool hts_lock(hts_table_t *table)
+{
+  if (!table->writable) return false;
+
+  hts_header_t *header = table->header;
+  int result = pthread_mutex_lock(&header->lock);
+  if (result == EOWNERDEAD)
+  {
+    pthread_mutex_consistent(&header->lock);
+    unsigned sequence = atomic_load_explicit(&header->sequence, memory_order_relaxed);
+    if (sequence & 1)
+      atomic_store_explicit(&header->sequence, sequence + 1, memory_order_release);
+  }
+  else if (result != 0)
+  {
+    return false;
+  }
+
+  atomic_fetch_add_explicit(&header->sequence, 1, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+  return true;
+}
+
+static void hts_unlock(hts_table_t *table)
+{
+  atomic_fetch_add_explicit(&table->header->sequence, 1, memory_order_release);
+  pthread_mutex_unlock(&table->header->lock);
+}
+
+/*
+ * Vloženie prvku do tabuľky.
+ *
+ * An existing item gets the new value. Returns false if the table is
+ * mapped read-only or its object is full.
+ */
+bool hts_insert(hts_table_t *table, const char *key, float value)
+{
+  if (table == NULL || key == NULL || !hts_lock(table)) return false;
+
+  hts_header_t *header = table->header;
+  size_t length = strlen(key);
+  uint64_t hash = ht_hash(key, length);
+  bool ok = true;
+
+  hts_item_t *item = hts_find(table, key, length, hash, NULL);
+  if (item != NULL)
+  {
+    atomic_store_explicit(&item->value, value, memory_order_relaxed);
+  }
+  else
+  {
+    uint64_t offset = atomic_load_explicit(&header->used, memory_order_relaxed);
+    size_t size = hts_record_size(length);
+    ok = size <= header->size - offset;
+    if (ok)
+    {
+      _Atomic uint64_t *bucket = &table->buckets[ht_hash_index(hash, header->bucket_count)];
+      item = (hts_item_t*)(table->base + offset);
+      item->hash = hash;
+      item->length = (uint32_t)length;
+      memcpy(item->key, key, length + 1);
+      atomic_store_explicit(&item->value, value, memory_order_relaxed);
+      atomic_store_explicit(&item->next, atomic_load_explicit(bucket, memory_order_relaxed),
+                            memory_order_relaxed);
+
+      atomic_store_explicit(&header->used, offset + size, memory_order_release);
+      atomic_store_explicit(bucket, offset, memory_order_release);
+      atomic_fetch_add_explicit(&header->count, 1, memory_order_relaxed);
+    }
+  }
+
+  hts_unlock(table);
+  return ok;
+}
+
+/*
+ * Zmazanie prvku z tabuľky.
+ *
+ * The item is only unlinked, its record stays. Returns false if the key was
+ * not in the table or the table is mapped read-only.
+ */
+bool hts_delete(hts_table_t *table, const char *key)
+{
+  if (table == NULL || key == NULL || !hts_lock(table)) return false;
+
+  size_t length = strlen(key);
+  _Atomic uint64_t *link;
+  hts_item_t *item = hts_find(table, key, length, ht_hash(key, length), &link);
+  if (item != NULL)
+  {
+    atomic_store_explicit(link, atomic_load_explicit(&item->next, memory_order_relaxed),
+                          memory_order_release);
+    atomic_fetch_sub_explicit(&table->header->count, 1, memory_order_relaxed);
+  }
+
+  hts_unlock(table);
+  return item != NULL;
+}
+
+/*
+ * Počet položiek tabuľky.
+ */
+int hts_count(hts_table_t *table)
+{
+  if (table == NULL) return 0;
+  return atomic_load_explicit(&table->header->count, memory_order_relaxed);
+}
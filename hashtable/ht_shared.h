@@ -0,0 +1,71 @@
+/*
+ * Hlavičkový súbor pre tabuľku v zdieľanej pamäti medzi procesmi.
+ *
+ * The whole table lives in one POSIX shared memory object: a header, the
+ * bucket array and an area of item records filled from the start. Chains
+ * and buckets hold offsets from the start of the object instead of
+ * pointers, so every process may map it at a different address.
+ *
+ * Writers serialize on a process-shared mutex and bump a sequence counter
+ * around every change. Readers take no lock: they repeat a lookup when the
+ * counter was odd or changed during it (a seqlock), so a process that only
+ * reads never writes to the shared memory. Records are never reused, a
+ * delete only unlinks its item; the space is lost until the object is
+ * created again. The number of buckets and the size are fixed at creation.
+ */
+
+#ifndef IAL_HASHTABLE_HT_SHARED_H
+#define IAL_HASHTABLE_HT_SHARED_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define HTS_MAGIC "IALHTSHM"
+#define HTS_VERSION 1
+
+// Hlavička zdieľaného objektu
+typedef struct hts_header {
+  char magic[8];         // HTS_MAGIC
+  uint32_t version;      // HTS_VERSION
+  uint32_t hash;         // HT_HASH procesu, ktorý objekt vytvoril
+  uint32_t bucket_count; // počet zoznamov synoným
+  uint64_t size;         // veľkosť objektu
+  uint64_t items;        // offset oblasti záznamov
+  _Atomic uint64_t used; // koniec zapísaných záznamov
+  atomic_uint sequence;  // nepárne počas zmeny (seqlock)
+  atomic_int count;      // počet položiek
+  pthread_mutex_t lock;  // zámok zapisovateľov medzi procesmi
+} hts_header_t;
+
+// Záznam položky, offsety sú od začiatku objektu
+typedef struct hts_item {
+  uint64_t hash;         // rozptylová hodnota kľúča
+  _Atomic uint64_t next; // offset ďalšieho synonyma, 0 na konci zoznamu
+  _Atomic float value;   // hodnota prvku
+  uint32_t length;       // dĺžka kľúča
+  char key[];            // kľúč ukončený nulou
+} hts_item_t;
+
+// Tabuľka namapovaná v jednom procese
+typedef struct hts_table {
+  char *base;                   // začiatok mapovania
+  size_t size;                  // veľkosť mapovania
+  hts_header_t *header;         // hlavička
+  _Atomic uint64_t *buckets;    // offsety prvých položiek zoznamov
+  bool writable;                // mapovanie umožňuje zápis
+} hts_table_t;
+
+hts_table_t *hts_create(const char *name, int buckets, size_t size);
+hts_table_t *hts_open(const char *name, bool writable);
+void hts_close(hts_table_t *table);
+bool hts_unlink(const char *name);
+
+bool hts_get(hts_table_t *table, const char *key, float *value);
+bool hts_insert(hts_table_t *table, const char *key, float value);
+bool hts_delete(hts_table_t *table, const char *key);
+int hts_count(hts_table_t *table);
+
+#endif
@@ -0,0 +1,338 @@
+/*
+ * Žurnál zmien tabuľky
+ *
+ * Layout of the log file:
+ *
+ *   ht_wal_header_t
+ *   records: ht_wal_record_t, key bytes, uint32_t checksum
+ *
+ * The checksum covers the record header and the key. Commits only append,
+ * so after a crash the file holds whole commits followed by at most one
+ * partly written one; ht_wal_recover stops at the first record that is cut
+ * off or fails its checksum and truncates the file there.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "ht_wal.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+// Hlavička súboru
+typedef struct ht_wal_header {
+  char magic[8];    // HT_WAL_MAGIC
+  uint32_t version; // HT_WAL_VERSION
+  uint32_t unused;
+} ht_wal_header_t;
+
+// FNV-1a, independent of the hash variant the table is built with
+static uint32_t ht_wal_checksum(const char *data, size_t size)
+{
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < size; i++)
+  {
+    hash ^= (unsigned char)data[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+static double ht_wal_now(void)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static bool ht_wal_write(int fd, const char *data, size_t size)
+{
+  while (size > 0)
+  {
+    ssize_t written = write(fd, data, size);
+    if (written < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    data += written;
+    size -= written;
+  }
+  return true;
+}
+
+/*
+ * Otvorenie žurnálu na pridávanie.
+ *
+ * A new or empty file gets a header, an existing log is appended to (after
+ * ht_wal_recover, which removes a cut off last commit). buffer_size 0 means
+ * HT_WAL_BUFFER. With commit_interval 0 or less every change is committed
+ * on its own. Returns NULL if the file cannot be opened or is not a log.
+ */
+ht_wal_t *ht_wal_open(const char *path, size_t buffer_size,
+                      double commit_interval)
+{
+  if (path == NULL) return NULL;
+  if (buffer_size == 0)
+    buffer_size = HT_WAL_BUFFER;
+
+  int fd = open(path, O_RDWR | O_CREAT | O_APPEND, 0644);
+  if (fd < 0) return NULL;
+
+  ht_wal_header_t header;
+  struct stat st;
+  bool ok = fstat(fd, &st) == 0;
+  if (ok && st.st_size == 0)
+  {
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, HT_WAL_MAGIC, sizeof(header.magic));
+    header.version = HT_WAL_VERSION;
+    ok = ht_wal_write(fd, (const char*)&header, sizeof(header)) && fsync(fd) == 0;
+  }
+  else if (ok)
+  {
+    ok = pread(fd, &header, sizeof(header), 0) == sizeof(header) &&
+         memcmp(header.magic, HT_WAL_MAGIC, sizeof(header.magic)) == 0 &&
+         header.version == HT_WAL_VERSION;
+  }
+
+  ht_wal_t *wal = ok ? (ht_wal_t*)malloc(sizeof(ht_wal_t)) : NULL;
+  char *buffer = wal != NULL ? (char*)malloc(buffer_size) : NULL;
+  if (buffer == NULL)
+  {
+    free(wal);
+    close(fd);
+    return NULL;
+  }
+
+  wal->fd = fd;
+  wal->buffer = buffer;
+  wal->size = buffer_size;
+  wal->used = 0;
+  wal->interval = commit_interval;
+  wal->last_commit = ht_wal_now();
+  wal->records = 0;
+  wal->commits = 0;
+  return wal;
+}
+
+/*
+ * Zápis zmien na disk.
+ *
+ * Writes the buffered records and waits for fsync. Returns false if either
+ * fails; the records then stay in the buffer and the file is cut back to
+ * its size before the commit, so a retry does not follow a partly written
+ * commit that recovery would stop at.
+ */
+bool ht_wal_commit(ht_wal_t *wal)
+{
+  if (wal == NULL) return false;
+
+  wal->last_commit = ht_wal_now();
+  if (wal->used == 0) return true;
+
+  off_t end = lseek(wal->fd, 0, SEEK_END);
+  if (end < 0) return false;
+
+  if (!ht_wal_write(wal->fd, wal->buffer, wal->used) || fsync(wal->fd) != 0)
+  {
+    if (ftruncate(wal->fd, end) == 0)
+      fsync(wal->fd);
+    return false;
+  }
+
+  wal->used = 0;
+  wal->commits++;
+  return true;
+}
+
+/*
+ * Zatvorenie žurnálu.
+ *
+ * Commits what is buffered first. Returns false if that fails, the log is
+ * closed anyway.
+ */
+bool ht_wal_close(ht_wal_t *wal)
+{
+  if (wal == NULL) return false;
+
+  bool ok = ht_wal_commit(wal);
+  ok = close(wal->fd) == 0 && ok;
+  free(wal->buffer);
+  free(wal);
+  return ok;
+}
+
+/*
+ * Appends a record to the buffer, committing first if it would not fit and
+ * after it once the interval has passed.
+ */
+static bool ht_wal_log(ht_wal_t *wal, uint8_t type, const char *key,
+                       float value)
+{
+  ht_wal_record_t record;
+  memset(&record, 0, sizeof(record));
+  record.type = type;
+  record.length = (uint32_t)strlen(key);
+  record.value = value;
+
+  size_t size = sizeof(record) + record.length + sizeof(uint32_t);
+  if (wal->used + size > wal->size && !ht_wal_commit(wal))
+    return false;
+
+  // A record larger than the buffer gets a buffer of its size
+  if (size > wal->size)
+  {
+    char *buffer = (char*)realloc(wal->buffer, size);
+    if (buffer == NULL) return false;
+    wal->buffer = buffer;
+    wal->size = size;
+  }
+
+  char *start = wal->buffer + wal->used;
+  memcpy(start, &record, sizeof(record));
+  memcpy(start + sizeof(record), key, record.length);
+  uint32_t checksum = ht_wal_checksum(start, sizeof(record) + record.length);
+  memcpy(start + sizeof(record) + record.length, &checksum, sizeof(checksum));
+  wal->used += size;
+  wal->records++;
+
+  if (wal->interval <= 0 || ht_wal_now() - wal->last_commit >= wal->interval)
+    return ht_wal_commit(wal);
+  return true;
+}
+
+/*
+ * Vloženie prvku so záznamom do žurnálu.
+ *
+ * The table is changed even if logging fails; false then means the change
+ * may not survive a crash.
+ */
+bool ht_wal_insert(ht_wal_t *wal, ht_table_t *table, char *key, float value)
+{
+  if (wal == NULL || table == NULL || key == NULL) return false;
+
+  bool ok = ht_wal_log(wal, HT_WAL_INSERT, key, value);
+  ht_insert(table, key, value);
+  return ok;
+}
+
+/*
+ * Zmazanie prvku so záznamom do žurnálu.
+ *
+ * Logged without looking the key up, replaying a delete of a missing key
+ * does nothing.
+ */
+bool ht_wal_delete(ht_wal_t *wal, ht_table_t *table, char *key)
+{
+  if (wal == NULL || table == NULL || key == NULL) return false;
+
+  bool ok = ht_wal_log(wal, HT_WAL_DELETE, key, 0.0f);
+  ht_delete(table, key);
+  return ok;
+}
+
+/*
+ * Obnovenie tabuľky zo žurnálu.
+ *
+ * Applies the records of the log in order to table, which should be empty
+ * after ht_init. A cut off or damaged tail, left by a crash during a
+ * commit, is dropped from the file. Returns the number of records applied,
+ * 0 if there is no log yet, or -1 if the file cannot be read or is not a
+ * log.
+ */
+long ht_wal_recover(const char *path, ht_table_t *table)
+{
+  if (path == NULL || table == NULL) return -1;
+
+  int fd = open(path, O_RDWR);
+  if (fd < 0) return errno == ENOENT ? 0 : -1;
+
+  struct stat st;
+  char *data = NULL;
+  size_t size = 0;
+  if (fstat(fd, &st) == 0)
+  {
+    size = st.st_size;
+    data = (char*)malloc(size + 1);
+  }
+  if (data == NULL || pread(fd, data, size, 0) != (ssize_t)size)
+  {
+    free(data);
+    close(fd);
+    return -1;
+  }
+
+  ht_wal_header_t header;
+  if (size < sizeof(header))
+  {
+    // Crashed before the header was synced, nothing was logged
+    free(data);
+    bool ok = ftruncate(fd, 0) == 0;
+    close(fd);
+    return ok ? 0 : -1;
+  }
+
+  memcpy(&header, data, sizeof(header));
+  if (memcmp(header.magic, HT_WAL_MAGIC, sizeof(header.magic)) != 0 ||
+      header.version != HT_WAL_VERSION)
+  {
+    free(data);
+    close(fd);
+    return -1;
+  }
+
+  long applied = 0;
+  bool ok = true;
+  size_t offset = sizeof(header);
+  char *key = NULL;
+  size_t key_size = 0;
+  while (size - offset >= sizeof(ht_wal_record_t))
+  {
+    ht_wal_record_t record;
+    memcpy(&record, data + offset, sizeof(record));
+    size_t end = offset + sizeof(record) + record.length;
+    if ((record.type != HT_WAL_INSERT && record.type != HT_WAL_DELETE) ||
+        record.length > size || end + sizeof(uint32_t) > size)
+      break;
+
+    uint32_t checksum;
+    memcpy(&checksum, data + end, sizeof(checksum));
+    if (checksum != ht_wal_checksum(data + offset, end - offset))
+      break;
+
+    if (record.length + 1 > key_size)
+    {
+      char *grown = (char*)realloc(key, record.length + 1);
+      if (grown == NULL)
+      {
+        ok = false;
+        break;
+      }
+      key = grown;
+      key_size = record.length + 1;
+    }
+    memcpy(key, data + offset + sizeof(record), record.length);
+    key[record.length] = '\0';
+
+    if (record.type == HT_WAL_INSERT)
+      ht_insert(table, key, record.value);
+    else
+      ht_delete(table, key);
+
+    applied++;
+    offset = end + sizeof(uint32_t);
+  }
+
+  // The tail is only dropped when it really is damaged
+  ok = ok && (offset == size || (ftruncate(fd, offset) == 0 && fsync(fd) == 0));
+  free(key);
+  free(data);
+  close(fd);
+  return ok ? applied : -1;
+}
@@ -0,0 +1,65 @@
+/*
+ * Hlavičkový súbor pre žurnál zmien tabuľky (write-ahead log).
+ *
+ * ht_wal_insert and ht_wal_delete change a table and append a record of the
+ * change to an in-memory buffer. The buffer is written to the log file and
+ * synced (fsync) as one group commit once it is full or commit_interval
+ * seconds have passed since the last commit, whichever comes first, so a
+ * crash loses at most the changes since the last commit. ht_wal_recover
+ * replays a log onto a table fresh from ht_init.
+ *
+ * The interval is checked when a change is logged; a program that goes
+ * quiet should call ht_wal_commit itself. Works with every engine.
+ */
+
+#ifndef IAL_HASHTABLE_HT_WAL_H
+#define IAL_HASHTABLE_HT_WAL_H
+
+#include "hashtable.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define HT_WAL_MAGIC "IALHTWAL"
+#define HT_WAL_VERSION 1
+
+// Default size of the buffer of one group commit
+#define HT_WAL_BUFFER 65536
+
+// Druh záznamu
+enum {
+  HT_WAL_INSERT = 1, // vloženie alebo prepísanie hodnoty
+  HT_WAL_DELETE = 2  // zmazanie kľúča
+};
+
+// Hlavička záznamu, nasleduje kľúč a kontrolný súčet (uint32_t)
+typedef struct ht_wal_record {
+  uint8_t type;    // HT_WAL_INSERT alebo HT_WAL_DELETE
+  uint8_t unused[3];
+  uint32_t length; // dĺžka kľúča
+  float value;     // nová hodnota pri HT_WAL_INSERT
+} ht_wal_record_t;
+
+// Otvorený žurnál
+typedef struct ht_wal {
+  int fd;                 // súbor žurnálu otvorený na pridávanie
+  char *buffer;           // záznamy od posledného zápisu
+  size_t size;            // veľkosť buffer
+  size_t used;            // obsadená časť buffer
+  double interval;        // najdlhší čas medzi zápismi v sekundách
+  double last_commit;     // čas posledného zápisu
+  unsigned long records;  // počet zapísaných záznamov
+  unsigned long commits;  // počet zápisov so synchronizáciou
+} ht_wal_t;
+
+ht_wal_t *ht_wal_open(const char *path, size_t buffer_size,
+                      double commit_interval);
+bool ht_wal_commit(ht_wal_t *wal);
+bool ht_wal_close(ht_wal_t *wal);
+
+bool ht_wal_insert(ht_wal_t *wal, ht_table_t *table, char *key, float value);
+bool ht_wal_delete(ht_wal_t *wal, ht_table_t *table, char *key);
+
+long ht_wal_recover(const char *path, ht_table_t *table);
+
+#endif
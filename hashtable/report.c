@@ -0,0 +1,64 @@
+/*
+ * Hash distribution report.
+ *
+ * Reads keys (one per line) from the file given as the first argument or from
+ * the standard input, inserts them into a table of HT_SIZE buckets (second
+ * argument, default HT_DEFAULT_SIZE) and prints chain length statistics for
+ * the hash function the program was built with. The table is not resized.
+ *
+ * Usage: make report KEYS=keys.txt [SIZE=101]
+ */
+
+#include "hashtable.h"
+#include "test_util.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_KEY_LENGTH 1024
+
+int main(int argc, char *argv[]) {
+  FILE *input = stdin;
+  if (argc > 1 && strcmp(argv[1], "-") != 0) {
+    input = fopen(argv[1], "r");
+    if (input == NULL) {
+      fprintf(stderr, "Cannot open %s\n", argv[1]);
+      return 1;
+    }
+  }
+
+  if (argc > 2) {
+    HT_SIZE = atoi(argv[2]);
+    if (HT_SIZE < 1) {
+      fprintf(stderr, "Table size must be positive\n");
+      return 1;
+    }
+  }
+
+  ht_table_t *table = (ht_table_t *)malloc(sizeof(ht_table_t));
+  if (table == NULL) {
+    return 1;
+  }
+  ht_init(table);
+
+  // Keep the bucket count fixed so all hash variants are compared equally
+  table->max_load = INFINITY;
+
+  char line[MAX_KEY_LENGTH];
+  while (fgets(line, sizeof(line), input) != NULL) {
+    line[strcspn(line, "\r\n")] = '\0';
+    if (line[0] != '\0') {
+      ht_insert(table, line, 0);
+    }
+  }
+
+  ht_print_distribution(table);
+
+  ht_delete_all(table);
+  free(table);
+  if (input != stdin) {
+    fclose(input);
+  }
+  return 0;
+}
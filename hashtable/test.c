@@ -1,7 +1,20 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include "hashtable.h"
+#include "ht_bloom.h"
+#include "ht_generic.h"
+#include "ht_frozen.h"
+#include "ht_hash.h"
+#include "ht_mapped.h"
+#include "ht_pool.h"
+#include "ht_wal.h"
 #include "test_util.h"
 #include <stdio.h>
+#include <signal.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
 
 #define INSERT_TEST_DATA(TABLE)                                                \
   ht_insert_many(TABLE, TEST_DATA, sizeof(TEST_DATA) / sizeof(TEST_DATA[0]));
@@ -76,6 +89,456 @@ INSERT_TEST_DATA(test_table)
 ht_delete_all(test_table);
 ENDTEST
 
+TEST(test_resize, "Grow and shrink the table")
+ht_init(test_table);
+char key[16];
+for (int i = 0; i < 60; i++) {
+  sprintf(key, "key%i", i);
+  ht_insert(test_table, key, i);
+}
+ht_print_distribution(test_table);
+int found = 0;
+for (int i = 0; i < 60; i++) {
+  sprintf(key, "key%i", i);
+  float *value = ht_get(test_table, key);
+  if (value != NULL && *value == i) {
+    found++;
+  }
+}
+printf("Found items: %i\n", found);
+for (int i = 5; i < 60; i++) {
+  sprintf(key, "key%i", i);
+  ht_delete(test_table, key);
+}
+ENDTEST
+
+TEST(test_long_key, "Insert and delete an item with a long key")
+ht_init(test_table);
+INSERT_TEST_DATA(test_table)
+char key[300];
+memset(key, 'x', sizeof(key) - 1);
+key[sizeof(key) - 1] = '\0';
+ht_insert(test_table, key, 1.5);
+ht_print_item_value(ht_get(test_table, key));
+ht_delete(test_table, key);
+ht_print_item_value(ht_get(test_table, key));
+ht_delete(test_table, "Tether");
+ht_insert(test_table, "Monero", 250.12);
+ENDTEST
+
+TEST(test_upsert, "Count words with get-or-insert and upsert")
+ht_init(test_table);
+char *words[] = {"Bitcoin", "Terra", "Bitcoin", "XRP",  "Terra",
+                 "Bitcoin", "Solana", "XRP",   "Bitcoin"};
+for (int i = 0; i < sizeof(words) / sizeof(words[0]); i++) {
+  (*ht_get_or_insert(test_table, words[i], 0, NULL))++;
+}
+bool inserted;
+ht_print_item_value(ht_get_or_insert(test_table, "Terra", 10, &inserted));
+printf("Inserted: %s\n", inserted ? "true" : "false");
+ht_print_item_value(ht_get_or_insert(test_table, "Tether", 10, &inserted));
+printf("Inserted: %s\n", inserted ? "true" : "false");
+*ht_upsert(test_table, "Solana", 5) *= 2;
+ht_print_item_value(ht_get(test_table, "Solana"));
+ENDTEST
+
+TEST(test_get_many, "Get values of many keys at once")
+ht_init(test_table);
+INSERT_TEST_DATA(test_table)
+char *keys[] = {"Bitcoin",  "Monero",   "Ethereum", "Binance Coin", "Cardano",
+                "Tether",   "XRP",      "Stellar",  "Solana",       "Polkadot",
+                "Dogecoin", "USD Coin", "Uniswap",  "Terra",        "Litecoin",
+                "Avalanche", "Chainlink", "Tron",   "Bitcoin"};
+float *values[sizeof(keys) / sizeof(keys[0])];
+ht_get_many(test_table, keys, sizeof(keys) / sizeof(keys[0]), values);
+for (int i = 0; i < sizeof(keys) / sizeof(keys[0]); i++) {
+  printf("%s: ", keys[i]);
+  ht_print_item_value(values[i]);
+}
+ENDTEST
+
+TEST(test_clear, "Clear the table and fill it again")
+ht_init(test_table);
+INSERT_TEST_DATA(test_table)
+ht_clear(test_table);
+ht_print_item_value(ht_get(test_table, "Bitcoin"));
+ht_insert(test_table, "Monero", 250.12);
+ht_insert(test_table, "Terra", 30.67);
+ht_print_item_value(ht_get(test_table, "Monero"));
+ENDTEST
+
+typedef struct scan_state {
+  int visits[sizeof(TEST_DATA) / sizeof(TEST_DATA[0])];
+  int others;
+} scan_state_t;
+
+void count_scanned(ht_item_t *item, void *data) {
+  scan_state_t *state = (scan_state_t *)data;
+  for (int i = 0; i < sizeof(TEST_DATA) / sizeof(TEST_DATA[0]); i++) {
+    if (strcmp(item->key, TEST_DATA[i].key) == 0) {
+      state->visits[i]++;
+      return;
+    }
+  }
+  state->others++;
+}
+
+TEST(test_scan, "Scan the table while it grows and shrinks")
+ht_init(test_table);
+INSERT_TEST_DATA(test_table)
+scan_state_t state = {{0}, 0};
+char key[32];
+int calls = 0;
+uint64_t cursor = 0;
+do {
+  cursor = ht_scan(test_table, cursor, count_scanned, &state, 3);
+  calls++;
+  // Grow the table during the first half of the scan, then shrink it back
+  for (int i = 0; i < 10; i++) {
+    sprintf(key, "scan%i", calls < 5 ? calls * 10 + i : (calls - 4) * 10 + i);
+    if (calls < 5) {
+      ht_insert(test_table, key, i);
+    } else {
+      ht_delete(test_table, key);
+    }
+  }
+} while (cursor != 0);
+int missing = 0, repeated = 0;
+for (int i = 0; i < sizeof(TEST_DATA) / sizeof(TEST_DATA[0]); i++) {
+  missing += state.visits[i] == 0;
+  repeated += state.visits[i] > 1;
+}
+printf("Calls: %i, missing: %i, repeated: %i\n", calls, missing, repeated);
+ENDTEST
+
+TEST(test_save_mapped, "Save the table and search in the mapped file")
+ht_init(test_table);
+INSERT_TEST_DATA(test_table)
+ht_delete(test_table, "Tether");
+printf("Saved: %s\n", ht_save(test_table, "test.map") ? "true" : "false");
+ht_mapped_t *map = ht_open_mapped("test.map");
+printf("Mapped: %s\n", map != NULL ? "true" : "false");
+char *keys[] = {"Bitcoin", "Tether", "Chainlink", "Monero", "Terra"};
+for (int i = 0; i < sizeof(keys) / sizeof(keys[0]); i++) {
+  const ht_mapped_item_t *item = ht_mapped_search(map, keys[i]);
+  printf("%s: ", keys[i]);
+  if (item != NULL) {
+    printf("%s %.2f\n", ht_mapped_key(map, item), *ht_mapped_get(map, keys[i]));
+  } else {
+    printf("NULL\n");
+  }
+}
+ht_close_mapped(map);
+remove("test.map");
+ENDTEST
+
+TEST(test_save_empty, "Save an empty and an emptied table")
+ht_init(test_table);
+printf("Saved empty: %s\n", ht_save(test_table, "test.map") ? "true" : "false");
+ht_mapped_t *map = ht_open_mapped("test.map");
+printf("Bitcoin: %s\n", ht_mapped_get(map, "Bitcoin") == NULL ? "NULL" : "found");
+ht_close_mapped(map);
+INSERT_TEST_DATA(test_table)
+ht_delete_all(test_table);
+printf("Saved emptied: %s\n", ht_save(test_table, "test.map") ? "true" : "false");
+map = ht_open_mapped("test.map");
+printf("Bitcoin: %s\n", ht_mapped_get(map, "Bitcoin") == NULL ? "NULL" : "found");
+ht_close_mapped(map);
+remove("test.map");
+ENDTEST
+
+TEST(test_freeze, "Freeze the table and search in the frozen copy")
+ht_init(test_table);
+INSERT_TEST_DATA(test_table)
+ht_frozen_t *frozen = ht_freeze(test_table);
+ht_delete(test_table, "Bitcoin");
+printf("Frozen items: %i\n", frozen->count);
+int found = 0;
+for (int i = 0; i < sizeof(TEST_DATA) / sizeof(TEST_DATA[0]); i++) {
+  const float *value = ht_frozen_get(frozen, TEST_DATA[i].key);
+  if (value != NULL && *value == TEST_DATA[i].value) {
+    found++;
+  }
+}
+printf("Found items: %i\n", found);
+char *keys[] = {"Bitcoin", "Monero", "Terra", ""};
+for (int i = 0; i < sizeof(keys) / sizeof(keys[0]); i++) {
+  printf("%s: ", keys[i]);
+  ht_print_item_value((float *)ht_frozen_get(frozen, keys[i]));
+}
+ht_frozen_free(frozen);
+ENDTEST
+
+TEST(test_wal, "Log changes and recover the table from the log")
+remove("test.wal");
+ht_table_t source;
+ht_init(&source);
+ht_wal_t *wal = ht_wal_open("test.wal", 256, 60);
+for (int i = 0; i < sizeof(TEST_DATA) / sizeof(TEST_DATA[0]); i++) {
+  ht_wal_insert(wal, &source, TEST_DATA[i].key, TEST_DATA[i].value);
+}
+ht_wal_delete(wal, &source, "Tether");
+ht_wal_insert(wal, &source, "Bitcoin", 60000);
+printf("Records: %lu, commits: %lu\n", wal->records, wal->commits);
+printf("Closed: %s\n", ht_wal_close(wal) ? "true" : "false");
+// A crash in the middle of the next commit
+FILE *file = fopen("test.wal", "ab");
+fwrite("\1\0\0\0\7", 1, 5, file);
+fclose(file);
+ht_init(test_table);
+printf("Recovered records: %li\n", ht_wal_recover("test.wal", test_table));
+ht_table_t again;
+ht_init(&again);
+printf("Recovered again: %li\n", ht_wal_recover("test.wal", &again));
+printf("Items: %i, Bitcoin: ", test_table->count);
+ht_print_item_value(ht_get(test_table, "Bitcoin"));
+ht_delete_all(&again);
+ht_delete_all(&source);
+remove("test.wal");
+ENDTEST
+
+TEST(test_wal_failed_commit, "Cut off a commit the file size limit stops")
+remove("test.wal");
+ht_table_t source;
+ht_init(&source);
+ht_wal_t *wal = ht_wal_open("test.wal", 4096, 60);
+for (int i = 0; i < sizeof(TEST_DATA) / sizeof(TEST_DATA[0]); i++) {
+  ht_wal_insert(wal, &source, TEST_DATA[i].key, TEST_DATA[i].value);
+}
+// Only the header and a few records fit below the limit
+struct rlimit limit, small;
+getrlimit(RLIMIT_FSIZE, &limit);
+small = limit;
+small.rlim_cur = 100;
+signal(SIGXFSZ, SIG_IGN);
+setrlimit(RLIMIT_FSIZE, &small);
+printf("Commit over the limit: %s\n", ht_wal_commit(wal) ? "true" : "false");
+setrlimit(RLIMIT_FSIZE, &limit);
+struct stat info;
+stat("test.wal", &info);
+printf("Size after the failed commit: %li\n", (long)info.st_size);
+printf("Commit: %s\n", ht_wal_commit(wal) ? "true" : "false");
+printf("Closed: %s\n", ht_wal_close(wal) ? "true" : "false");
+ht_init(test_table);
+printf("Recovered records: %li\n", ht_wal_recover("test.wal", test_table));
+ht_delete_all(&source);
+remove("test.wal");
+ENDTEST
+
+void test_hash_many() {
+  printf("[test_hash_many] Hash many keys at once\n");
+
+  char buffer[64][48];
+  const char *keys[64];
+  size_t lengths[64];
+  uint64_t hashes[64];
+  int mismatches = 0;
+
+  // Lengths of every kind, then only lengths the vector kernel takes
+  for (int pass = 0; pass < 2; pass++) {
+    for (int i = 0; i < 64; i++) {
+      lengths[i] = pass == 0 ? i % 41
+                             : HT_HASH_VECTOR_MIN +
+                                   i % (HT_HASH_VECTOR_MAX - HT_HASH_VECTOR_MIN + 1);
+      for (size_t j = 0; j < lengths[i]; j++) {
+        buffer[i][j] = (char)(i * 31 + j * 7 + 128);
+      }
+      buffer[i][lengths[i]] = '\0';
+      keys[i] = buffer[i];
+    }
+
+    for (int count = 0; count <= 64; count += 13) {
+      ht_hash_many(keys, lengths, count, hashes);
+      for (int i = 0; i < count; i++) {
+        mismatches += hashes[i] != ht_hash(keys[i], lengths[i]);
+      }
+    }
+  }
+  printf("Mismatches: %i\n\n", mismatches);
+}
+
+typedef struct coin {
+  float price;
+  int rank;
+} coin_t;
+
+HTDEC(int, float, int, ht_hash_int, HT_EQ)
+HTDEF(int, float, int, ht_hash_int, HT_EQ)
+HTDEC(long long, coin_t, coin, ht_hash_int, HT_EQ)
+HTDEF(long long, coin_t, coin, ht_hash_int, HT_EQ)
+
+void test_generic() {
+  printf("[test_generic] Tables generated for integer keys\n");
+
+  ht_int_t squares;
+  ht_int_init(&squares);
+  for (int i = 0; i < 1000; i++) {
+    ht_int_insert(&squares, i, (float)i * i);
+  }
+  for (int i = 0; i < 1000; i += 2) {
+    ht_int_delete(&squares, i);
+  }
+  int wrong = 0;
+  for (int i = 0; i < 1000; i++) {
+    float *value = ht_int_get(&squares, i);
+    if (i % 2 == 0 ? value != NULL : value == NULL || *value != (float)i * i) {
+      wrong++;
+    }
+  }
+  printf("Items: %i, capacity: %i, wrong: %i\n", squares.count,
+         squares.capacity, wrong);
+  ht_int_delete_all(&squares);
+
+  ht_coin_t coins;
+  ht_coin_init(&coins);
+  ht_coin_insert(&coins, 1LL << 40, (coin_t){53247.71, 1});
+  ht_coin_insert(&coins, -7, (coin_t){3208.67, 2});
+  ht_coin_insert(&coins, -7, (coin_t){3300.00, 2});
+  coin_t *coin = ht_coin_get(&coins, -7);
+  printf("Coin -7: %.2f, rank %i\n", coin->price, coin->rank);
+  coin = ht_coin_get(&coins, 1LL << 40);
+  printf("Coin 2^40: %.2f, rank %i\n", coin->price, coin->rank);
+  printf("Coin 5: %s\n", ht_coin_get(&coins, 5) == NULL ? "NULL" : "found");
+  ht_coin_delete_all(&coins);
+  printf("\n");
+}
+
+#ifdef HT_SWISS
+TEST(test_swiss_reuse, "Reuse slots of deleted items")
+ht_init(test_table);
+INSERT_TEST_DATA(test_table)
+ht_delete(test_table, "Bitcoin");
+ht_delete(test_table, "Tether");
+ht_delete(test_table, "Terra");
+ht_insert(test_table, "Monero", 250.12);
+ht_insert(test_table, "Stellar", 0.34);
+ht_insert(test_table, "Bitcoin", 53247.71);
+ht_search(test_table, "Tether");
+ht_get(test_table, "Monero");
+ENDTEST
+#endif
+
+#if !defined(HT_SWISS) && !defined(HT_CUCKOO)
+TEST(test_bloom, "Skip lookups of missing keys with a Bloom filter")
+ht_init(test_table);
+INSERT_TEST_DATA(test_table)
+printf("Enabled: %s\n", ht_enable_bloom(test_table, 0.01f, 0) ? "true" : "false");
+char key[16];
+for (int i = 0; i < 100; i++) {
+  sprintf(key, "bloom%i", i);
+  ht_insert(test_table, key, i);
+}
+for (int i = 0; i < 80; i++) {
+  sprintf(key, "bloom%i", i);
+  ht_delete(test_table, key);
+}
+int found = 0;
+for (int i = 0; i < sizeof(TEST_DATA) / sizeof(TEST_DATA[0]); i++) {
+  found += ht_get(test_table, TEST_DATA[i].key) != NULL;
+}
+for (int i = 80; i < 100; i++) {
+  sprintf(key, "bloom%i", i);
+  found += ht_get(test_table, key) != NULL;
+}
+printf("Found items: %i\n", found);
+int passed = 0;
+for (int i = 0; i < 1000; i++) {
+  sprintf(key, "missing%i", i);
+  passed += ht_bloom_contains(test_table->bloom, ht_hash(key, strlen(key)));
+}
+printf("Missing keys passed by the filter: %i of 1000\n", passed);
+ht_print_distribution(test_table);
+ht_search(test_table, "Tether");
+ht_get(test_table, "Monero");
+ht_clear(test_table);
+ht_get(test_table, "Bitcoin");
+ENDTEST
+
+TEST(test_cache, "Evict the least recently used items")
+ht_init(test_table);
+INSERT_TEST_DATA(test_table)
+ht_stats_t stats;
+ht_stats(test_table, &stats);
+printf("Item bytes: %zu\n", stats.item_bytes);
+printf("Enabled: %s\n",
+       ht_enable_cache(test_table, 5, 0, HT_CACHE_LRU) ? "true" : "false");
+printf("Items: %i\n", test_table->count);
+ht_stats(test_table, &stats);
+printf("Item bytes with links: %zu\n", stats.item_bytes);
+ht_get(test_table, "Terra");
+ht_insert(test_table, "Monero", 246.21);
+ht_insert(test_table, "Stellar", 0.31);
+char *keys[] = {"Uniswap", "Terra", "Litecoin", "Avalanche", "Chainlink"};
+for (int i = 0; i < sizeof(keys) / sizeof(keys[0]); i++) {
+  printf("%s: ", keys[i]);
+  ht_print_item_value(ht_get(test_table, keys[i]));
+}
+// CLOCK spares referenced items once
+ht_enable_cache(test_table, 4, 0, HT_CACHE_CLOCK);
+ht_get(test_table, "Monero");
+ht_insert(test_table, "Tezos", 6.12);
+ht_insert(test_table, "Algorand", 1.91);
+ht_print_distribution(test_table);
+ENDTEST
+
+TEST(test_pool, "Keep keys in a pool shared by two tables")
+ht_pool_t *pool = ht_pool_new(true);
+ht_table_t *tables[2] = {test_table, (ht_table_t *)malloc(sizeof(ht_table_t))};
+for (int i = 0; i < 2; i++) {
+  ht_init(tables[i]);
+  printf("Enabled: %s\n", ht_enable_pool(tables[i], pool) ? "true" : "false");
+  INSERT_TEST_DATA(tables[i])
+}
+printf("Pool: %zu bytes, %lu references\n", pool->bytes, pool->refs);
+ht_delete(test_table, "Bitcoin");
+ht_delete(tables[1], "Bitcoin");
+ht_delete(tables[1], "Ethereum");
+printf("Garbage: %zu bytes\n", pool->garbage);
+printf("Compacted: %s\n", ht_pool_compact(pool, tables, 2) ? "true" : "false");
+printf("Pool: %zu bytes, %zu garbage\n", pool->bytes, pool->garbage);
+ht_insert(tables[1], "Monero", 246.21);
+char *keys[] = {"Bitcoin", "Ethereum", "Terra", "Monero"};
+for (int i = 0; i < sizeof(keys) / sizeof(keys[0]); i++) {
+  printf("%s: ", keys[i]);
+  ht_print_item_value(ht_get(test_table, keys[i]));
+  printf("%s in the second table: ", keys[i]);
+  ht_print_item_value(ht_get(tables[1], keys[i]));
+}
+ht_delete_all(tables[1]);
+free(tables[1]);
+ht_print_distribution(test_table);
+ht_delete_all(test_table);
+ht_pool_free(pool);
+ENDTEST
+#endif
+
+#ifdef HT_CUCKOO
+TEST(test_cuckoo_kicks, "Fill the buckets until items go to the stash")
+ht_init(test_table);
+// Grow only when the stash is full
+test_table->max_load = 1.0f;
+char key[16];
+for (int i = 0; i < 200; i++) {
+  sprintf(key, "cuckoo%i", i);
+  ht_insert(test_table, key, i);
+}
+ht_print_distribution(test_table);
+int found = 0;
+for (int i = 0; i < 200; i++) {
+  sprintf(key, "cuckoo%i", i);
+  float *value = ht_get(test_table, key);
+  if (value != NULL && *value == i) {
+    found++;
+  }
+}
+printf("Found items: %i\n", found);
+for (int i = 3; i < 200; i++) {
+  sprintf(key, "cuckoo%i", i);
+  ht_delete(test_table, key);
+}
+ENDTEST
+#endif
+
 int main(int argc, char *argv[]) {
   init_uninitialized_item();
   init_test();
@@ -90,6 +553,30 @@ int main(int argc, char *argv[]) {
   test_get();
   test_delete();
   test_delete_all();
+  test_resize();
+  test_long_key();
+  test_upsert();
+  test_get_many();
+  test_clear();
+  test_scan();
+  test_save_mapped();
+  test_save_empty();
+  test_freeze();
+  test_wal();
+  test_wal_failed_commit();
+  test_generic();
+  test_hash_many();
+#ifdef HT_SWISS
+  test_swiss_reuse();
+#endif
+#if !defined(HT_SWISS) && !defined(HT_CUCKOO)
+  test_bloom();
+  test_cache();
+  test_pool();
+#endif
+#ifdef HT_CUCKOO
+  test_cuckoo_kicks();
+#endif
 
   free(uninitialized_item);
 }
@@ -0,0 +1,223 @@
+/*
+ * Stress and throughput test of the shared table (ht_concurrent.c).
+ *
+ * The stress part runs writers that insert, update and delete their own keys
+ * while readers look up the same keys without locks, and checks the final
+ * contents. Its output is deterministic and compared with ht_concurrent.out.
+ * The throughput part runs a read-mostly mix from 1 to HTC_TEST_MAX_THREADS
+ * threads and reports operations per second on stderr.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "ht_concurrent.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define HTC_TEST_MAX_THREADS 8
+#define HTC_TEST_KEYS 2000
+#define HTC_TEST_ROUNDS 20
+#define HTC_TEST_OPS 200000
+
+typedef struct test_thread {
+  htc_table_t *table;
+  int id;
+  int threads;
+  long errors;
+  long operations;
+} test_thread_t;
+
+static void make_key(char *key, int owner, int index) {
+  sprintf(key, "key-%d-%d", owner, index);
+}
+
+/*
+ * Writer: repeatedly inserts its keys, updates them and deletes every other
+ * one. Values always equal the key index, so readers can validate them.
+ */
+static void *stress_writer(void *arg) {
+  test_thread_t *thread = (test_thread_t *)arg;
+  htc_handle_t *handle = htc_attach(thread->table);
+  char key[32];
+
+  for (int round = 0; round < HTC_TEST_ROUNDS; round++) {
+    for (int i = 0; i < HTC_TEST_KEYS; i++) {
+      make_key(key, thread->id, i);
+      if (!htc_insert(handle, key, i)) {
+        thread->errors++;
+      }
+    }
+    for (int i = 0; i < HTC_TEST_KEYS; i += 2) {
+      make_key(key, thread->id, i);
+      if (!htc_delete(handle, key)) {
+        thread->errors++;
+      }
+    }
+  }
+
+  htc_detach(handle);
+  return NULL;
+}
+
+/*
+ * Reader: looks up keys of all writers while they change, a found value must
+ * always be the one its writer stored.
+ */
+static void *stress_reader(void *arg) {
+  test_thread_t *thread = (test_thread_t *)arg;
+  htc_handle_t *handle = htc_attach(thread->table);
+  char key[32];
+  float value;
+
+  for (int round = 0; round < HTC_TEST_ROUNDS; round++) {
+    for (int i = 0; i < HTC_TEST_KEYS; i++) {
+      make_key(key, i % thread->threads, i);
+      if (htc_get(handle, key, &value) && value != i) {
+        thread->errors++;
+      }
+    }
+  }
+
+  htc_detach(handle);
+  return NULL;
+}
+
+static void stress_test(int writers) {
+  htc_table_t table;
+  htc_init(&table, 1024);
+
+  pthread_t threads[2 * HTC_TEST_MAX_THREADS];
+  test_thread_t args[2 * HTC_TEST_MAX_THREADS];
+
+  for (int i = 0; i < 2 * writers; i++) {
+    args[i].table = &table;
+    args[i].id = i % writers;
+    args[i].threads = writers;
+    args[i].errors = 0;
+    pthread_create(&threads[i], NULL, i < writers ? stress_writer : stress_reader,
+                   &args[i]);
+  }
+
+  long errors = 0;
+  for (int i = 0; i < 2 * writers; i++) {
+    pthread_join(threads[i], NULL);
+    errors += args[i].errors;
+  }
+
+  // Only the odd keys of every writer must be left
+  htc_handle_t *handle = htc_attach(&table);
+  long missing = 0;
+  long extra = 0;
+  char key[32];
+  float value;
+  for (int w = 0; w < writers; w++) {
+    for (int i = 0; i < HTC_TEST_KEYS; i++) {
+      make_key(key, w, i);
+      bool found = htc_get(handle, key, &value);
+      if (i % 2 == 1 && (!found || value != i)) {
+        missing++;
+      } else if (i % 2 == 0 && found) {
+        extra++;
+      }
+    }
+  }
+  htc_detach(handle);
+
+  printf("[stress] %d writers, %d readers: items %d, errors %ld, missing %ld, "
+         "extra %ld\n",
+         writers, writers, atomic_load(&table.count), errors, missing, extra);
+
+  htc_destroy(&table);
+}
+
+/*
+ * Throughput worker: 90 % lookups, 5 % inserts, 5 % deletes over a shared
+ * key space.
+ */
+static void *mixed_worker(void *arg) {
+  test_thread_t *thread = (test_thread_t *)arg;
+  htc_handle_t *handle = htc_attach(thread->table);
+  unsigned seed = 12345u + thread->id;
+  char key[32];
+  float value;
+
+  for (int i = 0; i < HTC_TEST_OPS; i++) {
+    seed = seed * 1103515245u + 12345u;
+    int index = (seed >> 8) % HTC_TEST_KEYS;
+    int operation = (seed >> 20) % 100;
+
+    make_key(key, 0, index);
+    if (operation < 90) {
+      htc_get(handle, key, &value);
+    } else if (operation < 95) {
+      htc_insert(handle, key, index);
+    } else {
+      htc_delete(handle, key);
+    }
+  }
+  thread->operations = HTC_TEST_OPS;
+
+  htc_detach(handle);
+  return NULL;
+}
+
+static double seconds(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static void throughput_test(int count) {
+  htc_table_t table;
+  htc_init(&table, 4096);
+
+  htc_handle_t *handle = htc_attach(&table);
+  char key[32];
+  for (int i = 0; i < HTC_TEST_KEYS; i++) {
+    make_key(key, 0, i);
+    htc_insert(handle, key, i);
+  }
+  htc_detach(handle);
+
+  pthread_t threads[HTC_TEST_MAX_THREADS];
+  test_thread_t args[HTC_TEST_MAX_THREADS];
+
+  double start = seconds();
+  for (int i = 0; i < count; i++) {
+    args[i].table = &table;
+    args[i].id = i;
+    args[i].threads = count;
+    args[i].operations = 0;
+    pthread_create(&threads[i], NULL, mixed_worker, &args[i]);
+  }
+
+  long operations = 0;
+  for (int i = 0; i < count; i++) {
+    pthread_join(threads[i], NULL);
+    operations += args[i].operations;
+  }
+  double elapsed = seconds() - start;
+
+  fprintf(stderr, "[throughput] %d threads: %.0f ops/s\n", count,
+          operations / elapsed);
+
+  htc_destroy(&table);
+}
+
+int main(int argc, char *argv[]) {
+  printf("Concurrent Hash Table - testing script\n");
+  printf("--------------------------------------\n");
+  printf("\n");
+
+  for (int threads = 1; threads <= HTC_TEST_MAX_THREADS; threads *= 2) {
+    stress_test(threads);
+  }
+
+  for (int threads = 1; threads <= HTC_TEST_MAX_THREADS; threads *= 2) {
+    throughput_test(threads);
+  }
+
+  return 0;
+}
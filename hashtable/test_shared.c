@@ -0,0 +1,244 @@
+/*
+ * Test of the table in shared memory (ht_shared.c) with forked processes.
+ *
+ * A loader process fills the table, then reader processes check it through
+ * read-only mappings, also while a writer process updates values and adds
+ * and removes other keys. Each child reports its error count as its exit
+ * status. Writers that die holding the lock must neither block readers
+ * nor later writers. The output is deterministic and compared with
+ * ht_shared.out; lookups per second of the readers go to stderr.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "ht_shared.h"
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define HTS_TEST_KEYS 10000
+#define HTS_TEST_READERS 4
+#define HTS_TEST_ROUNDS 50
+#define HTS_TEST_CHURN 100
+
+static char name[64];
+
+static void make_key(char *key, const char *prefix, int index) {
+  sprintf(key, "%s-%d", prefix, index);
+}
+
+static double seconds(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static int loader(void) {
+  hts_table_t *table = hts_open(name, true);
+  if (table == NULL) {
+    return 1;
+  }
+
+  int errors = 0;
+  char key[32];
+  for (int i = 0; i < HTS_TEST_KEYS; i++) {
+    make_key(key, "key", i);
+    errors += !hts_insert(table, key, i);
+  }
+  hts_close(table);
+  return errors;
+}
+
+/*
+ * Updates every value round by round (a value stays equal to its index
+ * modulo HTS_TEST_KEYS) and inserts and deletes keys of its own meanwhile.
+ */
+static int updater(void) {
+  hts_table_t *table = hts_open(name, true);
+  if (table == NULL) {
+    return 1;
+  }
+
+  int errors = 0;
+  char key[32];
+  for (int round = 1; round <= HTS_TEST_ROUNDS; round++) {
+    for (int i = 0; i < HTS_TEST_KEYS; i++) {
+      make_key(key, "key", i);
+      errors += !hts_insert(table, key, i + round * HTS_TEST_KEYS);
+      if (i % (HTS_TEST_KEYS / HTS_TEST_CHURN) == 0) {
+        make_key(key, "churn", round * HTS_TEST_CHURN + i);
+        errors += !hts_insert(table, key, -1);
+        errors += !hts_delete(table, key);
+      }
+    }
+  }
+  hts_close(table);
+  return errors;
+}
+
+/*
+ * Looks every key up for the given number of rounds. A key must be found
+ * with a valid value, or be absent if it is odd and odd_deleted is set.
+ */
+static int reader(int rounds, bool odd_deleted) {
+  hts_table_t *table = hts_open(name, false);
+  if (table == NULL) {
+    return 1;
+  }
+
+  int errors = 0;
+  char key[32];
+  float value;
+  double start = seconds();
+  for (int round = 0; round < rounds; round++) {
+    for (int i = 0; i < HTS_TEST_KEYS; i++) {
+      make_key(key, "key", i);
+      bool found = hts_get(table, key, &value);
+      if (odd_deleted && i % 2 == 1) {
+        errors += found;
+      } else if (!found || (long)value % HTS_TEST_KEYS != i) {
+        errors++;
+      }
+    }
+  }
+  double elapsed = seconds() - start;
+  fprintf(stderr, "[reader %d] %.0f lookups/s\n", (int)getpid() % 100,
+          rounds * HTS_TEST_KEYS / elapsed);
+
+  hts_close(table);
+  return errors < 255 ? errors : 255;
+}
+
+/*
+ * Runs the children and returns the sum of their exit statuses. The first
+ * one is the writer, if any.
+ */
+static int run(int (*writer)(void), int readers, int rounds, bool odd_deleted) {
+  pid_t pids[HTS_TEST_READERS + 1];
+  int count = 0;
+
+  if (writer != NULL) {
+    if ((pids[count++] = fork()) == 0) {
+      _exit(writer());
+    }
+  }
+  for (int i = 0; i < readers; i++) {
+    if ((pids[count++] = fork()) == 0) {
+      _exit(reader(rounds, odd_deleted));
+    }
+  }
+
+  int errors = 0;
+  for (int i = 0; i < count; i++) {
+    int status;
+    waitpid(pids[i], &status, 0);
+    errors += WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+  }
+  return errors;
+}
+
+/*
+ * A child takes the writer lock, starts a change and dies.
+ */
+static bool dead_writer(hts_table_t *table) {
+  pid_t pid = fork();
+  if (pid == 0) {
+    pthread_mutex_lock(&table->header->lock);
+    atomic_fetch_add(&table->header->sequence, 1);
+    _exit(0);
+  }
+  waitpid(pid, NULL, 0);
+
+  float value;
+  return hts_insert(table, "after-crash", 1) &&
+         hts_get(table, "after-crash", &value) && value == 1;
+}
+
+/*
+ * A child takes the writer lock, starts a change and is killed while it
+ * holds the lock. A reader with a read-only mapping, which cannot take the
+ * lock over, must still finish its lookup; it is killed if it hangs.
+ */
+static bool killed_writer(void) {
+  int ready[2];
+  if (pipe(ready) != 0) {
+    return false;
+  }
+
+  pid_t writer = fork();
+  if (writer == 0) {
+    hts_table_t *table = hts_open(name, true);
+    if (table != NULL) {
+      pthread_mutex_lock(&table->header->lock);
+      atomic_fetch_add(&table->header->sequence, 1);
+    }
+    write(ready[1], "", 1);
+    pause();
+    _exit(0);
+  }
+  char byte;
+  bool locked = read(ready[0], &byte, 1) == 1;
+  kill(writer, SIGKILL);
+  waitpid(writer, NULL, 0);
+  close(ready[0]);
+  close(ready[1]);
+
+  pid_t reader = fork();
+  if (reader == 0) {
+    alarm(10);
+    hts_table_t *table = hts_open(name, false);
+    float value;
+    _exit(table != NULL && hts_get(table, "key-0", &value) ? 0 : 1);
+  }
+  int status;
+  waitpid(reader, &status, 0);
+  return locked && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+int main(int argc, char *argv[]) {
+  printf("Shared Memory Hash Table - testing script\n");
+  printf("-----------------------------------------\n");
+  printf("\n");
+
+  sprintf(name, "/ial-hts-test-%d", (int)getpid());
+  hts_table_t *table = hts_create(name, 4096, 4 << 20);
+  if (table == NULL) {
+    printf("Cannot create %s\n", name);
+    return 1;
+  }
+
+  int errors = run(loader, 0, 0, false);
+  printf("[load] items %d, errors %d\n", hts_count(table), errors);
+
+  errors = run(NULL, HTS_TEST_READERS, HTS_TEST_ROUNDS, false);
+  printf("[read] %d readers: errors %d\n", HTS_TEST_READERS, errors);
+
+  errors = run(updater, HTS_TEST_READERS, HTS_TEST_ROUNDS, false);
+  printf("[update] 1 writer, %d readers: items %d, errors %d\n",
+         HTS_TEST_READERS, hts_count(table), errors);
+
+  char key[32];
+  for (int i = 1; i < HTS_TEST_KEYS; i += 2) {
+    make_key(key, "key", i);
+    hts_delete(table, key);
+  }
+  errors = run(NULL, HTS_TEST_READERS, 1, true);
+  printf("[delete] items %d, errors %d\n", hts_count(table), errors);
+
+  hts_table_t *readonly = hts_open(name, false);
+  printf("[read-only] insert refused: %s\n",
+         !hts_insert(readonly, "key-1", 1) ? "true" : "false");
+  hts_close(readonly);
+
+  printf("[dead writer] insert after takeover: %s\n",
+         dead_writer(table) ? "true" : "false");
+  printf("[killed writer] read while the lock is held: %s\n",
+         killed_writer() ? "true" : "false");
+
+  hts_close(table);
+  hts_unlink(name);
+  return 0;
+}
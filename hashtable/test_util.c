@@ -1,7 +1,9 @@
 #include "test_util.h"
 #include "hashtable.h"
+#include "ht_hash.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 ht_item_t *uninitialized_item;
 
@@ -21,32 +23,240 @@ void ht_print_item(ht_item_t *item) {
   }
 }
 
+#ifdef HT_SWISS
+
+/*
+ * In the open addressing engine a bucket is one group of HT_GROUP_SIZE slots
+ * and its chain are the items stored in the group.
+ */
+static int ht_group_items(ht_table_t *table, int group, ht_item_t *items[]) {
+  int count = 0;
+  for (int i = 0; i < HT_GROUP_SIZE; i++) {
+    int slot = group * HT_GROUP_SIZE + i;
+    if (table->ctrl[slot] >= 0) {
+      items[count++] = &table->slots[slot];
+    }
+  }
+  return count;
+}
+
+void ht_chain_stats(ht_table_t *table, ht_chain_stats_t *stats) {
+  stats->buckets = table->size / HT_GROUP_SIZE;
+  stats->items = 0;
+  stats->used_buckets = 0;
+  stats->max_chain = 0;
+
+  if (table->ctrl != NULL) {
+    ht_item_t *items[HT_GROUP_SIZE];
+    for (int i = 0; i < stats->buckets; i++) {
+      int count = 0;
+      for (int j = ht_group_items(table, i, items) - 1; j >= 0; j--) {
+        if (items[j]->key != uninitialized_item->key) {
+          count++;
+        }
+      }
+      if (count > 0) {
+        stats->used_buckets++;
+      }
+      if (count > stats->max_chain) {
+        stats->max_chain = count;
+      }
+      stats->items += count;
+    }
+  }
+}
+
+#elif defined(HT_CUCKOO)
+
+/*
+ * In the cuckoo engine a bucket holds up to HT_CUCKOO_SLOTS items, its chain
+ * are the items stored in it. Items in the stash belong to no bucket.
+ */
+static int ht_bucket_items(ht_table_t *table, int bucket, ht_item_t *items[]) {
+  int count = 0;
+  for (int i = 0; i < HT_CUCKOO_SLOTS; i++) {
+    if (table->buckets[bucket].items[i] != NULL) {
+      items[count++] = table->buckets[bucket].items[i];
+    }
+  }
+  return count;
+}
+
+void ht_chain_stats(ht_table_t *table, ht_chain_stats_t *stats) {
+  stats->buckets = table->size / HT_CUCKOO_SLOTS;
+  stats->items = 0;
+  stats->used_buckets = 0;
+  stats->max_chain = 0;
+
+  if (table->buckets != NULL) {
+    ht_item_t *items[HT_CUCKOO_SLOTS];
+    for (int i = 0; i < stats->buckets; i++) {
+      int count = 0;
+      for (int j = ht_bucket_items(table, i, items) - 1; j >= 0; j--) {
+        if (items[j] != uninitialized_item) {
+          count++;
+        }
+      }
+      if (count > 0) {
+        stats->used_buckets++;
+      }
+      if (count > stats->max_chain) {
+        stats->max_chain = count;
+      }
+      stats->items += count;
+    }
+    stats->items += table->stash_count;
+  }
+}
+
+#else
+
+static void ht_chain_stats_add(ht_chain_stats_t *stats, ht_item_t *item) {
+  int count = 0;
+  while (item != NULL) {
+    if (item != uninitialized_item) {
+      count++;
+    }
+    item = item->next;
+  }
+  if (count > 0) {
+    stats->used_buckets++;
+  }
+  if (count > stats->max_chain) {
+    stats->max_chain = count;
+  }
+  stats->items += count;
+}
+
+void ht_chain_stats(ht_table_t *table, ht_chain_stats_t *stats) {
+  stats->buckets = table->size;
+  stats->items = 0;
+  stats->used_buckets = 0;
+  stats->max_chain = 0;
+
+  if (table->buckets != NULL) {
+    for (int i = 0; i < table->size; i++) {
+      ht_chain_stats_add(stats, table->buckets[i]);
+    }
+  }
+  if (table->old_buckets != NULL) {
+    for (int i = table->rehash_index; i < table->old_size; i++) {
+      ht_chain_stats_add(stats, table->old_buckets[i]);
+    }
+  }
+}
+
+static void ht_print_chain(int index, ht_item_t *item) {
+  printf("%i: ", index);
+  while (item != NULL) {
+    printf("(%s,%.2f)", item->key, item->value);
+    item = item->next;
+  }
+  printf("\n");
+}
+
+#endif
+
 void ht_print_table(ht_table_t *table) {
-  int max_count = 0;
-  int sum_count = 0;
+  ht_chain_stats_t stats;
 
   printf("------------HASH TABLE--------------\n");
-  for (int i = 0; i < HT_SIZE; i++) {
+#ifdef HT_SWISS
+  for (int i = 0; i < table->size / HT_GROUP_SIZE; i++) {
+    printf("%i: ", i);
+    if (table->ctrl != NULL) {
+      ht_item_t *items[HT_GROUP_SIZE];
+      int count = ht_group_items(table, i, items);
+      for (int j = 0; j < count; j++) {
+        printf("(%s,%.2f)", items[j]->key, items[j]->value);
+      }
+    }
+    printf("\n");
+  }
+#elif defined(HT_CUCKOO)
+  for (int i = 0; i < table->size / HT_CUCKOO_SLOTS; i++) {
     printf("%i: ", i);
-    int count = 0;
-    ht_item_t *item = (*table)[i];
-    while (item != NULL) {
-      printf("(%s,%.2f)", item->key, item->value);
-      if (item != uninitialized_item) {
-        count++;
+    if (table->buckets != NULL) {
+      ht_item_t *items[HT_CUCKOO_SLOTS];
+      int count = ht_bucket_items(table, i, items);
+      for (int j = 0; j < count; j++) {
+        printf("(%s,%.2f)", items[j]->key, items[j]->value);
       }
-      item = item->next;
     }
     printf("\n");
-    if (count > max_count) {
-      max_count = count;
+  }
+
+  if (table->buckets != NULL && table->stash_count > 0) {
+    printf("---------------STASH----------------\n");
+    for (int i = 0; i < table->stash_count; i++) {
+      printf("(%s,%.2f)", table->stash[i]->key, table->stash[i]->value);
+    }
+    printf("\n");
+  }
+#else
+  for (int i = 0; i < table->size; i++) {
+    ht_print_chain(i, table->buckets != NULL ? table->buckets[i] : NULL);
+  }
+
+  if (table->old_buckets != NULL) {
+    printf("-------------REHASHING--------------\n");
+    for (int i = table->rehash_index; i < table->old_size; i++) {
+      ht_print_chain(i, table->old_buckets[i]);
     }
-    sum_count += count;
   }
+#endif
 
+  ht_chain_stats(table, &stats);
+  printf("------------------------------------\n");
+  printf("Total items in hash table: %i\n", stats.items);
+  printf("Maximum hash collisions: %i\n",
+         stats.max_chain == 0 ? 0 : stats.max_chain - 1);
   printf("------------------------------------\n");
-  printf("Total items in hash table: %i\n", sum_count);
-  printf("Maximum hash collisions: %i\n", max_count == 0 ? 0 : max_count - 1);
+}
+
+void ht_print_distribution(ht_table_t *table) {
+  ht_stats_t stats;
+  ht_stats(table, &stats);
+
+  int used_buckets = stats.buckets - stats.empty_buckets;
+
+  printf("------------DISTRIBUTION------------\n");
+  printf("Hash function: %s\n", ht_hash_name());
+  printf("Buckets: %i\n", stats.buckets);
+  printf("Total items in hash table: %i\n", stats.items);
+  printf("Empty buckets: %i\n", stats.empty_buckets);
+  printf("Load factor: %.2f\n", stats.load_factor);
+  printf("Average chain length: %.2f\n",
+         used_buckets == 0 ? 0.0f : (float)stats.items / used_buckets);
+  printf("Maximum chain length: %i\n", stats.max_chain);
+  printf("Maximum hash collisions: %i\n",
+         stats.max_chain == 0 ? 0 : stats.max_chain - 1);
+  printf("Chain lengths:");
+  for (int i = 0; i < HT_STATS_CHAINS; i++) {
+    printf(" %i%s:%i", i, i == HT_STATS_CHAINS - 1 ? "+" : "", stats.chains[i]);
+  }
+  printf("\n");
+  if (stats.filter_bytes > 0) {
+    printf("Bloom filter: %zu bytes, estimated false positives %.4f\n",
+           stats.filter_bytes, stats.filter_fpr);
+  }
+  if (stats.cache_bytes > 0) {
+    printf("Cache: %zu bytes, evicted items %lu\n", stats.cache_bytes,
+           stats.evictions);
+  }
+  if (stats.pool_bytes > 0) {
+    printf("Key pool: %zu bytes, garbage %zu\n", stats.pool_bytes,
+           stats.pool_garbage);
+  }
+#ifdef HT_STATS
+  printf("Lookups: %lu (hits %lu, misses %lu)\n", stats.counters.lookups,
+         stats.counters.hits, stats.counters.misses);
+  printf("Lookups answered by the filter: %lu\n", stats.counters.filtered);
+  printf("Key comparisons per lookup: %.2f\n",
+         stats.counters.lookups == 0
+             ? 0.0
+             : (double)stats.counters.comparisons / stats.counters.lookups);
+#endif
   printf("------------------------------------\n");
 }
 
@@ -57,15 +267,66 @@ void init_uninitialized_item() {
   uninitialized_item->next = NULL;
 }
 
+#ifdef HT_SWISS
+
 void init_test_table(ht_table_t **table) {
+  static signed char uninitialized_ctrl[HT_GROUP_SIZE];
+  static ht_item_t uninitialized_slots[HT_GROUP_SIZE];
+
+  memset(uninitialized_ctrl, HT_CTRL_EMPTY, sizeof(uninitialized_ctrl));
+  uninitialized_ctrl[0] = 0;
+  uninitialized_slots[0] = *uninitialized_item;
+
   (*table) = (ht_table_t *)malloc(sizeof(ht_table_t));
-  for (int i = 0; i < MAX_HT_SIZE; i++) {
-    (**table)[i] = uninitialized_item;
-  };
+  (*table)->ctrl = uninitialized_ctrl;
+  (*table)->slots = uninitialized_slots;
+  (*table)->size = HT_GROUP_SIZE;
+  (*table)->min_size = HT_GROUP_SIZE;
+  (*table)->count = -1;
+  (*table)->growth_left = 0;
+  (*table)->max_load = 0;
+  (*table)->min_load = 0;
 }
 
-void ht_insert_many(ht_table_t *table, const ht_item_t items[], int count) {
-  for (int i = 0; i < count; i++) {
-    ht_insert(table, items[i].key, items[i].value);
-  }
+#elif defined(HT_CUCKOO)
+
+void init_test_table(ht_table_t **table) {
+  static ht_bucket_t uninitialized_bucket;
+
+  memset(&uninitialized_bucket, 0, sizeof(uninitialized_bucket));
+  uninitialized_bucket.items[0] = uninitialized_item;
+
+  (*table) = (ht_table_t *)malloc(sizeof(ht_table_t));
+  (*table)->buckets = &uninitialized_bucket;
+  (*table)->size = HT_CUCKOO_SLOTS;
+  (*table)->min_size = HT_CUCKOO_SLOTS;
+  (*table)->count = -1;
+  (*table)->stash_count = 0;
+  (*table)->random = 0;
+  (*table)->max_load = 0;
+  (*table)->min_load = 0;
+}
+
+#else
+
+void init_test_table(ht_table_t **table) {
+  (*table) = (ht_table_t *)malloc(sizeof(ht_table_t));
+  (*table)->buckets = &uninitialized_item;
+  (*table)->size = 1;
+  (*table)->occupied = NULL;
+  (*table)->occupied_count = 0;
+  (*table)->old_buckets = NULL;
+  (*table)->old_size = 0;
+  (*table)->rehash_index = 0;
+  (*table)->min_size = 1;
+  (*table)->count = -1;
+  (*table)->max_load = 0;
+  (*table)->min_load = 0;
+  memset(&(*table)->arena, 0, sizeof(ht_arena_t));
+  (*table)->bloom = NULL;
+  (*table)->cache = NULL;
+  (*table)->pool = NULL;
+  (*table)->pool_owned = false;
 }
+
+#endif
@@ -17,12 +17,23 @@
   printf("\n");                                                                \
   }
 
+// Chain length statistics used by ht_print_table (skips uninitialized_item)
+// (with -DHT_SWISS a bucket is a group of HT_GROUP_SIZE slots, with
+// -DHT_CUCKOO one of HT_CUCKOO_SLOTS slots)
+typedef struct ht_chain_stats {
+  int buckets;      // number of buckets of the table
+  int items;        // number of items in the table
+  int used_buckets; // buckets with at least one item
+  int max_chain;    // length of the longest chain
+} ht_chain_stats_t;
+
 extern ht_item_t *uninitialized_item;
 
 void ht_print_item_value(float *value);
 void ht_print_item(ht_item_t *item);
 void ht_print_table(ht_table_t *table);
-void ht_insert_many(ht_table_t *table, const ht_item_t items[], int count);
+void ht_chain_stats(ht_table_t *table, ht_chain_stats_t *stats);
+void ht_print_distribution(ht_table_t *table);
 
 void init_uninitialized_item();
 void init_test_table(ht_table_t **table);